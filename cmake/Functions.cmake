@@ -29,6 +29,13 @@ function(setup_lib)
 
 	add_library(${lib_name} SHARED ${lib_src})
 	target_link_libraries(${lib_name} ${CMAKE_THREAD_LIBS_INIT})
+
+	# SIMD kernels are compiled for specific instruction sets
+	# and selected at runtime by CPU detection.
+	if(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|i.86")
+		set_source_files_properties(${lib_src_dir}/simd/AVX2.cpp PROPERTIES COMPILE_FLAGS "-mavx2 -mfma")
+		set_source_files_properties(${lib_src_dir}/simd/AVX512.cpp PROPERTIES COMPILE_FLAGS "-mavx512f -mfma")
+	endif()
 	set_target_properties(${lib_name} PROPERTIES LIBRARY_OUTPUT_DIRECTORY ${lib_dir})
 	target_include_directories(
 		${lib_name}
@@ -83,6 +90,32 @@ function(setup_bin)
 
 endfunction()
 
+# Compile each test source into an executable
+# and register it with CTest
+function(setup_tests)
+
+	file(GLOB test_list ${test_src_dir}/*.cpp)
+
+	foreach(test_src ${test_list})
+		get_filename_component(test_name ${test_src} NAME_WE)
+		set(test_name "test_${test_name}")
+
+		message(STATUS "*** Configuring test ${test_name}")
+
+		add_executable(${test_name} ${test_src})
+		target_link_libraries(${test_name} ${lib_name})
+		target_include_directories(
+			${test_name}
+			PRIVATE
+			${lib_header_dirs}
+			${dep_header_dirs}
+			)
+
+		add_test(NAME ${test_name} COMMAND ${test_name})
+	endforeach()
+
+endfunction()
+
 # Issue warning messages
 function(warning messages)
 	message(STATUS "*** Warning *** ")
@@ -1,10 +1,24 @@
 #ifndef DLOG_HPP
 #define DLOG_HPP
 
-#include "threadpool.hpp"
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <queue>
+#include <condition_variable>
+#include <future>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <type_traits>
 
 namespace Async
 {
+	typedef unsigned int uint;
+
+	typedef std::unique_lock<std::mutex> ulock;
+	typedef std::lock_guard<std::mutex> glock;
+
 	template<typename T> using sp = std::shared_ptr<T>;
 	typedef std::packaged_task<void()> ptask;
 	typedef std::function<void()> vfun;
@@ -65,6 +79,8 @@ namespace Async
 		/// the input is printed or ignored.
 		bool out;
 
+		/// Prints the queued logs in the order
+		/// in which they were flushed.
 		class Printer
 		{
 		private:
@@ -74,51 +90,26 @@ namespace Async
 				std::mutex mtx;
 				std::queue<std::queue<vfun>> queue;
 				std::condition_variable semaphore;
+				bool eol = false;
 			} printer;
 
-			ThreadPool tp;
-
-			uint min_workers;
-			uint max_workers;
-
-		public:
-
-			Printer(const uint _workers = std::thread::hardware_concurrency())
-				:
-				  tp(_workers),
-				  min_workers(4),
-				  max_workers(std::thread::hardware_concurrency() > 16 ? 16 : std::thread::hardware_concurrency())
-			{
-
-			}
-
-			~Printer()
-			{
-				tp.wait();
-			}
+			std::thread worker;
 
-			inline void enqueue(std::queue<vfun>&& _queue)
+			inline void run()
 			{
-				glock queue_lock(printer.mtx);
-				printer.queue.emplace(std::move(_queue));
-
-				if (tp.tasks_enqueued() > 4 * tp.worker_count())
-				{
-					tp.resize(tp.tasks_enqueued() > max_workers ? max_workers : tp.tasks_enqueued());
-				}
-				else if (tp.tasks_enqueued() < tp.worker_count() / 4)
-				{
-					tp.resize(tp.tasks_enqueued() > min_workers ? tp.tasks_enqueued() : min_workers);
-				}
+				std::queue<vfun> queue;
+				vfun fun;
 
-				tp.enqueue([&]
+				while (true)
 				{
-					std::queue<vfun> queue;
-					vfun fun;
 					{
 						ulock printer_lock(printer.mtx);
 
-						printer.semaphore.wait(printer_lock, [&]{ return !printer.queue.empty(); });
+						printer.semaphore.wait(printer_lock, [&]{ return printer.eol || !printer.queue.empty(); });
+						if (printer.queue.empty())
+						{
+							return;
+						}
 						queue = std::move(printer.queue.front());
 						printer.queue.pop();
 					}
@@ -129,7 +120,36 @@ namespace Async
 						queue.pop();
 						fun();
 					}
-				});
+				}
+			}
+
+		public:
+
+			Printer()
+				:
+				  worker([&]{ run(); })
+			{
+
+			}
+
+			/// Prints everything that is still queued before returning.
+			~Printer()
+			{
+				{
+					glock printer_lock(printer.mtx);
+					printer.eol = true;
+				}
+				printer.semaphore.notify_one();
+				worker.join();
+			}
+
+			inline void enqueue(std::queue<vfun>&& _queue)
+			{
+				{
+					glock queue_lock(printer.mtx);
+					printer.queue.emplace(std::move(_queue));
+				}
+				printer.semaphore.notify_one();
 			}
 
 			inline static Printer& get()
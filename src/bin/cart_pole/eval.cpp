@@ -2,6 +2,8 @@
 
 namespace CartPole
 {
+	ulong Rnd::seed(0);
+
 	real Pole::Def::theta = 6.0;
 	real Pole::Def::omega = 0.0;
 	real Pole::Def::mass = 0.1;
@@ -48,6 +50,12 @@ namespace CartPole
 		/// Evaluate the network and set the fitness
 		steps = eval_env(_net, env, histograms);
 
+		/// The fitness of a partial evaluation is meaningless
+		if (_net.is_cancelled())
+		{
+			return;
+		}
+
 		if (steps >= Max::steps)
 		{
 			dlog() << "Network " << _net.id << " passed the initial test!\n"
@@ -60,6 +68,10 @@ namespace CartPole
 			for (const Env& gen_env : Gen::envs)
 			{
 				gen_steps = eval_env(_net, gen_env, histograms, true);
+				if (_net.is_cancelled())
+				{
+					return;
+				}
 				steps += gen_steps;
 				if (gen_steps < Max::steps)
 				{
@@ -92,12 +104,17 @@ namespace CartPole
 		std::stringstream hist;
 		std::vector<real> actions(_net.get_output().size());
 
-		/// Evaluate the network
+		/// Each episode starts from rest
+		_net.reset_state();
+
+		/// Evaluate the network.
+		/// Give up if another network has already solved the task.
 		while (steps <= Max::steps &&
-			   env.in_range())
+			   env.in_range() &&
+			   !_net.is_cancelled())
 		{
 			_net.eval(env.norm_state());
-			actions = _net.get_output();
+			_net.get_output(actions);
 			env.update(actions);
 			if (_add_hist)
 			{
@@ -175,7 +192,7 @@ namespace CartPole
 
 	bool setup(Config& _config)
 	{
-		Rnd::rng.seed(std::chrono::high_resolution_clock().now().time_since_epoch().count());
+		Rnd::seed = _config.seed;
 
 		std::stringstream problems;
 
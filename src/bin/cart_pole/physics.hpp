@@ -12,12 +12,30 @@ namespace CartPole
 
 	namespace Rnd
 	{
-		static std::mutex mtx;
-		static std::mt19937_64 rng;
-		static std::normal_distribution<real> nd(0.0,0.00001);
+		/// Seed for threads which have no active stream.
+		/// Set to the master seed by setup() (cf. eval.cpp).
+		extern ulong seed;
+
+		/// The random stream of the network being evaluated
+		/// in the calling thread. Falls back to a per-thread
+		/// stream outside of evaluation (e.g., in test()).
+		/// Not static, so the fallback stream is shared by
+		/// all translation units.
+		inline Rng& rng()
+		{
+			Rng* active(Rng::active());
+			if (active)
+			{
+				return *active;
+			}
+			static thread_local Rng fallback(seed);
+			return fallback;
+		}
+
 		static real jitter()
 		{
-			return nd(rng);
+			std::normal_distribution<real> nd(0.0, 0.00001);
+			return nd(rng());
 		}
 	};
 
@@ -112,15 +130,14 @@ namespace CartPole
 									 const real _max = Max::theta / 5.0,
 									 const bool _rnd_sign = true)
 		{
-			glock lk(Rnd::mtx);
-			static std::uniform_real_distribution<real> theta_dist(rad(_min), rad(_max));
-			static std::uniform_real_distribution<real> theta_sign(0.0, 1.0);
+			std::uniform_real_distribution<real> theta_dist(rad(_min), rad(_max));
+			std::uniform_real_distribution<real> theta_sign(0.0, 1.0);
 			if (_rnd_sign &&
-				theta_sign(Rnd::rng) < 0.5)
+				theta_sign(Rnd::rng()) < 0.5)
 			{
-				return -theta_dist(Rnd::rng);
+				return -theta_dist(Rnd::rng());
 			}
-			return theta_dist(Rnd::rng);
+			return theta_dist(Rnd::rng());
 		}
 
 	private:
@@ -274,15 +291,14 @@ namespace CartPole
 								   const real _max = Max::pos / 5.0,
 								   const bool _rnd_sign = true)
 		{
-			glock lk(Rnd::mtx);
-			static std::uniform_real_distribution<real> pos_dist(_min, _max);
-			static std::uniform_real_distribution<real> pos_sign(0.0, 1.0);
+			std::uniform_real_distribution<real> pos_dist(_min, _max);
+			std::uniform_real_distribution<real> pos_sign(0.0, 1.0);
 			if (_rnd_sign &&
-				pos_sign(Rnd::rng) < 0.5)
+				pos_sign(Rnd::rng()) < 0.5)
 			{
-				return -pos_dist(Rnd::rng);
+				return -pos_dist(Rnd::rng());
 			}
-			return pos_dist(Rnd::rng);
+			return pos_dist(Rnd::rng());
 		}
 
 	private:
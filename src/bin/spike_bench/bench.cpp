@@ -0,0 +1,111 @@
+#include "bench.hpp"
+
+namespace SpikeBench
+{
+	bool setup(Config& _config)
+	{
+		_config.net.type = NT::Spiking;
+		_config.net.spiking.enc = Enc::Lat;
+
+		return _config.validate();
+	}
+
+	/// Evaluate every network on every input once
+	static void eval_all(std::vector<NetRef>& _nets,
+						 const std::vector<std::vector<real>>& _inputs)
+	{
+		for (auto& net : _nets)
+		{
+			for (const auto& input : _inputs)
+			{
+				net.get().eval(input);
+			}
+		}
+	}
+
+	/// Average time per evaluation (in microseconds).
+	/// An untimed warm-up pass comes first so that
+	/// the first-touch allocations are not timed.
+	static real time_evals(std::vector<NetRef>& _nets,
+						   const std::vector<std::vector<real>>& _inputs,
+						   const uint _reps)
+	{
+		eval_all(_nets, _inputs);
+
+		const auto start(std::chrono::steady_clock::now());
+
+		for (uint r = 0; r < _reps; ++r)
+		{
+			eval_all(_nets, _inputs);
+		}
+
+		const std::chrono::duration<real, std::micro> elapsed(std::chrono::steady_clock::now() - start);
+		return elapsed.count() / (_reps * _nets.size() * _inputs.size());
+	}
+
+	void run(Config& _config, const uint _reps)
+	{
+		Cortex::ThreadPool tp(1);
+
+		/// The same random inputs for all networks
+		std::mt19937_64 gen(_config.seed);
+		std::uniform_real_distribution<real> dist(0.0, 1.0);
+		std::vector<std::vector<real>> inputs(16, std::vector<real>(_config.node.roles.at(NR::I)));
+		for (auto& input : inputs)
+		{
+			for (auto& x : input)
+			{
+				x = dist(gen);
+			}
+		}
+
+		dlog() << "Time step: " << _config.net.spiking.timestep
+			   << ", delay: " << _config.net.spiking.delay
+			   << ", max. latency: " << _config.net.spiking.max.latency << "\n\n"
+			   << "Hidden\tDensity\tNodes\tLinks\tEvent (us)\tClock (us)\tFaster";
+
+		for (const uint h : hidden)
+		{
+			for (const uint d : density)
+			{
+				_config.node.roles.at(NR::H) = h;
+
+				Ecosystem es(_config, tp);
+				if (!es.init())
+				{
+					dlog() << "Failed to initialise the ecosystem";
+					return;
+				}
+
+				std::vector<NetRef> nets(es.get_nets());
+				real nodes(0.0);
+				real links(0.0);
+				for (auto& net : nets)
+				{
+					Rng::Scope scope(net.get().get_rng());
+					const uint extra(d * net.get().node_count());
+					for (uint l = 0; l < extra; ++l)
+					{
+						net.get().mutate(Mut::AddLink);
+					}
+					nodes += net.get().node_count();
+					links += net.get().link_count();
+				}
+
+				_config.net.spiking.sim = Sim::Event;
+				const real event(time_evals(nets, inputs, _reps));
+
+				_config.net.spiking.sim = Sim::Clock;
+				const real clock(time_evals(nets, inputs, _reps));
+
+				dlog() << h << "\t"
+					   << d << "\t"
+					   << nodes / nets.size() << "\t"
+					   << links / nets.size() << "\t"
+					   << event << "\t\t"
+					   << clock << "\t\t"
+					   << (event <= clock ? "event" : "clock");
+			}
+		}
+	}
+}
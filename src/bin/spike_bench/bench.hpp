@@ -0,0 +1,25 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "Cortex.hpp"
+
+using namespace Cortex;
+
+namespace SpikeBench
+{
+	/// Numbers of hidden nodes
+	const std::vector<uint> hidden = {0, 16, 64, 256};
+
+	/// Extra links per node added to the
+	/// initial networks to increase the activity
+	const std::vector<uint> density = {0, 2, 8};
+
+	bool setup(Config& _config);
+
+	/// Time the event-driven and the clock-driven
+	/// simulations on the same networks and inputs
+	/// and print the time per evaluation.
+	void run(Config& _config, const uint _reps);
+}
+
+#endif // BENCH_HPP
@@ -0,0 +1,19 @@
+#include "bench.hpp"
+
+int main( int argc, char* argv[] )
+{
+	TCLAP::CmdLine cmd( "Spiking simulation benchmark", ' ', version, false );
+	TCLAP::ValueArg<std::string> config_file( "c", "config", "Configuration file", false, "config.json", "string", cmd );
+	TCLAP::ValueArg<uint> reps( "r", "reps", "Repetitions", false, 1, "uint", cmd );
+	cmd.parse( argc, argv );
+
+	Config config(config_file.getValue());
+	if (!SpikeBench::setup(config))
+	{
+		return 0;
+	}
+
+	SpikeBench::run(config, reps.getValue());
+
+	return 0;
+}
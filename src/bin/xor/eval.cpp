@@ -6,31 +6,28 @@ namespace Xor
 	{
 		std::vector<real> output;
 
-		{
-//			dlog d;
-//			d << "Net " << _net.id << " eval:\n";
-			for ( const auto& in : input )
-			{
-				_net.eval( in );
-				output.emplace_back( _net.get_output().front() );
-//				d << "\t";
-//				for (const auto v : in)
-//				{
-//					d << "\t" << v;
-//				}
-//				d << ": " << output.back() << "\n";
-			}
-		}
+		/// Evaluate all patterns in one batch
+		_net.eval_batch(input, samples, output);
+
+		const uint out_count(_net.node_count(NR::O));
+
+//		dlog d;
+//		d << "Net " << _net.id << " eval:\n";
+//		for (uint idx = 0; idx < samples; ++idx)
+//		{
+//			d << "\t" << input[2 * idx] << "\t" << input[2 * idx + 1] << ": " << output[idx * out_count] << "\n";
+//		}
 
 		/// Fitness calculated with the tanh or step functions
 		real fitness(_net.cfg.fit.tgt);
 
-		for ( uint idx = 0; idx < output.size(); ++idx )
+		for ( uint idx = 0; idx < samples; ++idx )
 		{
-			if ( ((idx == 0 || idx == 3) && output[idx] > boundary) ||
-				 ((idx == 1 || idx == 2) && output[idx] <= boundary) )
+			const real out(output[idx * out_count]);
+			if ( ((idx == 0 || idx == 3) && out > boundary) ||
+				 ((idx == 1 || idx == 2) && out <= boundary) )
 			{
-				fitness -= std::fabs(output[idx] - boundary);
+				fitness -= std::fabs(out - boundary);
 			}
 		}
 
@@ -14,14 +14,18 @@ namespace Xor
 
 	bool setup(Config& _config);
 
-	const std::vector<std::vector<real>> input =
+	/// Input patterns (row-major, one pattern per row)
+	const std::vector<real> input =
 	{
-		{0.0, 0.0}, // 0
-		{1.0, 0.0}, // 1
-		{0.0, 1.0}, // 1
-		{1.0, 1.0}  // 0
+		0.0, 0.0, // 0
+		1.0, 0.0, // 1
+		0.0, 1.0, // 1
+		1.0, 1.0  // 0
 	};
 
+	/// Number of patterns
+	const uint samples = 4;
+
 	void eval(Net& _net);
 }
 
@@ -0,0 +1,133 @@
+#include "Archipelago.hpp"
+
+namespace Cortex
+{
+	Archipelago::Archipelago(Config& _cfg, ThreadPool& _tp, const uint _run)
+		:
+		  cfg(_cfg),
+		  sources(_cfg.islands.count),
+		  targets(_cfg.islands.count),
+		  finished(new std::atomic<bool>[_cfg.islands.count]),
+		  solved(false),
+		  winner(0)
+	{
+		const uint count(cfg.islands.count);
+
+		for (uint i = 0; i < count; ++i)
+		{
+			islands.emplace_back(new Ecosystem(_cfg, _tp, _run, this, i));
+			finished[i].store(false);
+		}
+
+		/// An island can be at most (count - 1) migrations ahead
+		/// of any of its neighbours (the neighbour waits for it),
+		/// so the channels never fill up.
+		channels.resize(count * count);
+		for (uint src = 0; src < count; ++src)
+		{
+			for (uint tgt = 0; tgt < count; ++tgt)
+			{
+				if (tgt == src ||
+					(cfg.islands.topology == Topology::Ring && tgt != (src + 1) % count))
+				{
+					continue;
+				}
+
+				channels[src * count + tgt].reset(new Channel<MigrantsPtr>(count + 1));
+				targets[src].push_back(tgt);
+				sources[tgt].push_back(src);
+			}
+		}
+	}
+
+	bool Archipelago::init()
+	{
+		for (auto& island : islands)
+		{
+			if (!island->init())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Archipelago::emigrate(const uint _island)
+	{
+		for (const uint tgt : targets[_island])
+		{
+			/// Each neighbour gets its own copies
+			MigrantsPtr migrants(new Migrants());
+			islands[_island]->select_migrants(*migrants);
+
+			while (!channel(_island, tgt).push(std::move(migrants)))
+			{
+				if (is_solved())
+				{
+					return;
+				}
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	std::vector<MigrantsPtr> Archipelago::immigrate(const uint _island)
+	{
+		std::vector<MigrantsPtr> arrivals;
+
+		for (const uint src : sources[_island])
+		{
+			Channel<MigrantsPtr>& ch(channel(src, _island));
+			MigrantsPtr migrants;
+
+			while (!ch.pop(migrants))
+			{
+				if (is_solved())
+				{
+					break;
+				}
+
+				if (finished[src].load())
+				{
+					/// The last migrants might have been sent
+					/// just before the neighbour finished.
+					ch.pop(migrants);
+					break;
+				}
+
+				std::this_thread::yield();
+			}
+
+			if (migrants)
+			{
+				arrivals.push_back(std::move(migrants));
+			}
+		}
+
+		return arrivals;
+	}
+
+	void Archipelago::mark_solved(const uint _island)
+	{
+		bool expected(false);
+		if (solved.compare_exchange_strong(expected, true))
+		{
+			winner.store(_island);
+		}
+
+		for (auto& island : islands)
+		{
+			island->abort();
+		}
+	}
+
+	uint Archipelago::total_evals()
+	{
+		uint evals(0);
+		for (auto& island : islands)
+		{
+			evals += island->total_evals();
+		}
+		return evals;
+	}
+}
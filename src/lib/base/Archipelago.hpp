@@ -0,0 +1,135 @@
+#ifndef ARCHIPELAGO_HPP
+#define ARCHIPELAGO_HPP
+
+#include "Ecosystem.hpp"
+#include "Channel.hpp"
+
+namespace Cortex
+{
+	/// Copies of the best networks of an island.
+	/// The copies are made by the sending island
+	/// and only read by the receiving one, so the
+	/// two islands never touch the same network.
+	struct Migrants
+	{
+		/// Generation in which the migrants left
+		uint age;
+
+		/// One species for each migrant
+		/// holding the genotype of the original
+		emap<uint, Species> species;
+
+		emap<uint, Net> nets;
+	};
+
+	using MigrantsPtr = std::unique_ptr<Migrants>;
+
+	/// \brief A group of ecosystems (islands)
+	/// evolved concurrently for a single run.
+	///
+	/// Each island evolves on its own thread with its own
+	/// species, while the evaluations of all islands share
+	/// the threadpool. Every few generations, each island
+	/// sends copies of its best networks to its neighbours
+	/// over lock-free channels (one for each pair of islands).
+	///
+	/// An island waits for the migrants of the current
+	/// migration from each of its neighbours, so the
+	/// outcome of a run does not depend on the timing
+	/// of the threads. The wait is abandoned once the
+	/// task has been solved or the neighbour has finished.
+	class Archipelago
+	{
+	private:
+
+		Config& cfg;
+
+		std::vector<std::unique_ptr<Ecosystem>> islands;
+
+		/// Channels indexed by source * count + target.
+		/// Only the pairs allowed by the topology have a channel.
+		std::vector<std::unique_ptr<Channel<MigrantsPtr>>> channels;
+
+		/// Islands which send migrants to each island
+		std::vector<std::vector<uint>> sources;
+
+		/// Islands which receive migrants from each island
+		std::vector<std::vector<uint>> targets;
+
+		/// Islands which have stopped evolving
+		std::unique_ptr<std::atomic<bool>[]> finished;
+
+		std::atomic<bool> solved;
+
+		/// The island which solved the task
+		std::atomic<uint> winner;
+
+		inline Channel<MigrantsPtr>& channel(const uint _src, const uint _tgt)
+		{
+			return *channels[_src * islands.size() + _tgt];
+		}
+
+	public:
+
+		Archipelago(Config& _cfg, ThreadPool& _tp, const uint _run);
+
+		bool init();
+
+		/// Evolve all islands until the task is solved
+		/// or the maximal age is reached.
+		template<typename F, typename ... Args>
+		inline void evolve(F&& _f, Args&& ... _args)
+		{
+			auto sail([&](const uint _island)
+			{
+				Ecosystem& es(*islands[_island]);
+				while (es.get_age() <= cfg.ecosystem.max.age &&
+					   !is_solved())
+				{
+					es.eval(_f, _args...);
+				}
+				finished[_island].store(true);
+			});
+
+			/// The calling thread evolves the first island
+			std::vector<std::thread> threads;
+			for (uint i = 1; i < islands.size(); ++i)
+			{
+				threads.emplace_back(sail, i);
+			}
+			sail(0);
+
+			for (auto& t : threads)
+			{
+				t.join();
+			}
+		}
+
+		/// Send copies of the best networks
+		/// of an island to its neighbours.
+		void emigrate(const uint _island);
+
+		/// Collect the migrants sent to an island.
+		std::vector<MigrantsPtr> immigrate(const uint _island);
+
+		/// Stop all islands once one of them has solved the task
+		void mark_solved(const uint _island);
+
+		inline bool is_solved() const
+		{
+			return solved.load();
+		}
+
+		/// The island which solved the task
+		/// (the first one if it has not been solved).
+		inline Ecosystem& get_winner()
+		{
+			return *islands[winner.load()];
+		}
+
+		/// Evaluations performed by all islands
+		uint total_evals();
+	};
+}
+
+#endif // ARCHIPELAGO_HPP
@@ -0,0 +1,102 @@
+#include "Dispatcher.hpp"
+
+namespace Cortex
+{
+	constexpr uint Dispatcher::chunks_per_worker;
+
+	void Dispatcher::build(emap<uint, Net>& _nets, const Sched _sched, const bool _timed, const uint _workers, const bool _dirty_only)
+	{
+		sched = _sched;
+		items.clear();
+		chunks.clear();
+		skipped.clear();
+
+		if (sched == Sched::Fifo)
+		{
+			for (auto& net : _nets)
+			{
+				if (!_dirty_only ||
+					net.second.is_dirty())
+				{
+					items.push_back({net.second, 0.0});
+				}
+				else
+				{
+					skipped.emplace_back(net.second);
+				}
+			}
+			return;
+		}
+
+		/// Average evaluation time per node and link
+		/// for estimating the cost of new networks.
+		/// Without timing, the cost is the size.
+		real time(0.0);
+		real size(0.0);
+		for (const auto& net : _nets)
+		{
+			if (_timed &&
+				net.second.get_eval_time() > 0.0)
+			{
+				time += net.second.get_eval_time();
+				size += net.second.node_count() + net.second.link_count();
+			}
+		}
+		const real rate(size > 0.0 ? time / size : 1.0);
+
+		real total(0.0);
+		for (auto& net : _nets)
+		{
+			if (_dirty_only &&
+				!net.second.is_dirty())
+			{
+				skipped.emplace_back(net.second);
+				continue;
+			}
+
+			real cost(_timed ? net.second.get_eval_time() : 0.0);
+			if (cost <= 0.0)
+			{
+				cost = rate * (net.second.node_count() + net.second.link_count());
+			}
+			items.push_back({net.second, cost});
+			total += cost;
+		}
+
+		std::sort(items.begin(), items.end(), [](const Item& _l, const Item& _r)
+		{
+			return (_l.cost > _r.cost ||
+					(_l.cost == _r.cost && _l.net.get().id < _r.net.get().id));
+		});
+
+		if (sched == Sched::LPT)
+		{
+			for (uint n = 0; n < items.size(); ++n)
+			{
+				chunks.push_back(n + 1);
+			}
+			return;
+		}
+
+		/// Expensive networks get a chunk of their own.
+		/// The rest are batched until the chunk reaches
+		/// the average cost.
+		const real threshold(total / (std::max<uint>(_workers, 1) * chunks_per_worker));
+		real cost(0.0);
+		for (uint n = 0; n < items.size(); ++n)
+		{
+			cost += items[n].cost;
+			if (cost >= threshold)
+			{
+				chunks.push_back(n + 1);
+				cost = 0.0;
+			}
+		}
+
+		if (chunks.empty() ||
+			chunks.back() < items.size())
+		{
+			chunks.push_back(items.size());
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#ifndef DISPATCHER_HPP
+#define DISPATCHER_HPP
+
+#include "Net.hpp"
+#include "ThreadPool.hpp"
+
+namespace Cortex
+{
+	/// \brief Schedules the evaluation of networks.
+	///
+	/// Evaluation times can differ by orders of magnitude
+	/// (e.g., a network which passes the first test of
+	/// a task might be subjected to many more tests).
+	/// If an expensive network is evaluated last, all but
+	/// one of the threads sit idle until it is finished.
+	///
+	/// The dispatcher estimates the cost of each network
+	/// from its size (nodes and links). Depending on the policy,
+	/// the networks are then dispatched in order of decreasing
+	/// cost (longest processing time first), with ties broken
+	/// by ID and small networks optionally batched together
+	/// to reduce the overhead. The order therefore only depends
+	/// on the networks, so runs with a fixed seed are reproducible.
+	///
+	/// Optionally, the cost is estimated from the duration of
+	/// the last evaluation of each network instead (falling back
+	/// to its size for networks which have not been evaluated yet).
+	/// This reflects the actual work better, but the order changes
+	/// from run to run (cf. Config::ecosystem.timed).
+	class Dispatcher
+	{
+	private:
+
+		struct Item
+		{
+			NetRef net;
+			real cost;
+		};
+
+		Sched sched = Sched::Fifo;
+
+		/// Networks in the order of dispatching
+		std::vector<Item> items;
+
+		/// Networks left out because they have not changed
+		std::vector<NetRef> skipped;
+
+		/// End of each chunk in the list of items
+		std::vector<uint> chunks;
+
+		/// Number of chunks per worker.
+		/// Networks cheaper than the average chunk
+		/// are batched with their neighbours.
+		static constexpr uint chunks_per_worker = 4;
+
+	public:
+
+		/// Prepare the evaluation of a set of networks.
+		/// If _timed is set, the costs are estimated from
+		/// measured evaluation times (not reproducible).
+		/// If _dirty_only is set, networks which have not
+		/// changed since their last evaluation are left out
+		/// and run() records their last fitness again.
+		void build(emap<uint, Net>& _nets, const Sched _sched, const bool _timed, const uint _workers, const bool _dirty_only = false);
+
+		/// Evaluate the networks and record
+		/// the duration of each evaluation.
+		/// Returns once all networks have been evaluated,
+		/// _token has been cancelled or the threadpool has been stopped.
+		template<typename F>
+		void run(ThreadPool& _tp, F&& _eval, const Token& _token)
+		{
+			/// Networks which have not changed keep their fitness,
+			/// but their fitness statistics are updated as if they
+			/// had been evaluated, so memoisation does not change
+			/// the course of the evolution.
+			for (auto& net : skipped)
+			{
+				net.get().replay_fitness();
+			}
+
+			auto eval([&](Net& _net)
+			{
+				const auto start(std::chrono::steady_clock::now());
+				_eval(_net);
+				_net.set_eval_time(std::chrono::duration<real>(std::chrono::steady_clock::now() - start).count());
+			});
+
+			if (sched == Sched::Fifo)
+			{
+				_tp.parallel_for(0, items.size(), [&](const uint _n)
+				{
+					eval(items[_n].net.get());
+				}, 1, &_token);
+				return;
+			}
+
+			/// Each worker takes the next chunk in line
+			/// as soon as it is done with the previous one.
+			std::atomic<uint> next(0);
+			_tp.parallel_for(0, std::min<uint>(_tp.worker_count(), chunks.size()), [&](const uint)
+			{
+				uint chunk(0);
+				while (!_tp.stopped() &&
+					   !_token.cancelled() &&
+					   (chunk = next.fetch_add(1)) < chunks.size())
+				{
+					for (uint n = (chunk == 0 ? 0 : chunks[chunk - 1]); n < chunks[chunk]; ++n)
+					{
+						eval(items[n].net.get());
+					}
+				}
+			}, 1, &_token);
+		}
+	};
+}
+
+#endif // DISPATCHER_HPP
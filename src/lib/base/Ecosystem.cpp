@@ -1,33 +1,46 @@
 #include "Ecosystem.hpp"
+#include "Archipelago.hpp"
 
 namespace Cortex
 {
 
-	Ecosystem::Ecosystem(Config& _cfg)
+	Ecosystem::Ecosystem(Config& _cfg,
+						 ThreadPool& _tp,
+						 const uint _run,
+						 Archipelago* _archipelago,
+						 const uint _island)
 		:
 		  age(1),
+		  run(_run),
+		  island(_island),
 		  cfg(_cfg),
-		  tp(_cfg.threads)
+		  tp(_tp),
+		  archipelago(_archipelago),
+		  rng(_cfg.seed, (uint64_t(_island) << 32) | _run),
+		  last_spc_id(0),
+		  last_net_id(0)
 	{
 //		dlog() << "Ecosystem created in thread " << std::this_thread::get_id();
 	}
 
 	Ecosystem::~Ecosystem()
 	{
-//		dlog() << "Stopping threadpool...";
-		tp.stop();
+		/// Evaluations are never running at this point
+		/// (Ecosystem::eval() waits for them),
+		/// so the threadpool can be left as it is.
 	}
 
 	bool Ecosystem::init()
 	{
-		if (!cfg.validate())
-		{
-			return false;
-		}
+		Rng::Scope scope(rng);
 
+		/// The configuration is validated once by the experiment
+		/// since it is shared by all concurrent runs.
 		species.clear();
+		species_index.clear();
 		nets.clear();
-		cfg.reset_ids();
+		last_spc_id = 0;
+		last_net_id = 0;
 
 		uint spc_id(0);
 		uint net_id(0);
@@ -37,7 +50,7 @@ namespace Cortex
 		for (uint s = 0; s < cfg.species.init.count; ++s)
 		{
 			/// Generate a species ID
-			spc_id = cfg.new_spc_id();
+			spc_id = new_spc_id();
 			Genotype gen(cfg.node.roles);
 			gen.add(NR::H, s);
 			insert_species(spc_id, gen);
@@ -45,7 +58,7 @@ namespace Cortex
 			/// Generate networks
 			for (uint n = 0; n < nets_per_spc; ++n)
 			{
-				net_id = cfg.new_net_id();
+				net_id = new_net_id();
 //				dlog() << "Generating network " << net_id;
 				insert_net(net_id, spc_id);
 				nets.at(net_id).init();
@@ -64,12 +77,10 @@ namespace Cortex
 	uint Ecosystem::get_species_id(const Genotype& _gen)
 	{
 		uint spc_id(0);
-		for (auto& s : species)
+		auto it(species_index.find(_gen));
+		if (it != species_index.end())
 		{
-			if (s.second == _gen)
-			{
-				return s.first;
-			}
+			return it->second;
 		}
 
 		if (cfg.species.max.count == 0 ||
@@ -77,7 +88,7 @@ namespace Cortex
 		{
 			/// The species doesn't exist and we can create it.
 			/// Get an ID for the new species.
-			spc_id = cfg.new_spc_id();
+			spc_id = new_spc_id();
 
 			/// Register the new species with the ecosystem.
 			insert_species(spc_id, _gen);
@@ -86,6 +97,24 @@ namespace Cortex
 		return spc_id;
 	}
 
+	void Ecosystem::mark_solved(const uint _net)
+	{
+		{
+			glock lk(stats.mtx);
+			if (!stats.solved)
+			{
+				stats.champ_id = _net;
+				stats.solved = true;
+			}
+		}
+		abort();
+
+		if (archipelago)
+		{
+			archipelago->mark_solved(island);
+		}
+	}
+
 	void Ecosystem::evolve()
 	{
 		find_champ();
@@ -154,6 +183,7 @@ namespace Cortex
 			if (it->second.is_empty())
 			{
 //				dlog() << "Removing empty species " << it->second.id;
+				species_index.erase(it->second.get_genotype());
 				it = species.erase(it);
 			}
 			else
@@ -167,8 +197,7 @@ namespace Cortex
 	{
 
 		/// Select a species
-		hmap<uint, real> mating_wheel;
-		hmap<uint, real> culling_wheel;
+		Wheel<uint> mating_wheel;
 
 		/// Mean fitness
 		real old_fit_mean(0.0);
@@ -178,8 +207,7 @@ namespace Cortex
 		uint spc_count(0);
 		for (auto& spc : species)
 		{
-			mating_wheel[spc.first] = spc.second.mating_chance();
-			culling_wheel[spc.first] = spc.second.culling_chance();
+			mating_wheel.set(spc.first, spc.second.mating_chance());
 		}
 
 		/// Produce offspring equal to the mating chance
@@ -203,11 +231,11 @@ namespace Cortex
 			} while (spc_id == 0 || p1 == 0 || p2 == 0);
 
 			/// Get the next network ID.
-			uint new_net_id(cfg.new_net_id());
+			uint net_id(new_net_id());
 
 			/// Create a new network.
-			insert_net(new_net_id, spc_id);
-			nets.at(new_net_id).crossover(nets.at(p1), nets.at(p2));
+			insert_net(net_id, spc_id);
+			nets.at(net_id).crossover(nets.at(p1), nets.at(p2));
 
 			/// Increase the offspring count
 			--offspring;
@@ -228,16 +256,33 @@ namespace Cortex
 			}
 		}
 
+		cull();
+	}
+
+	void Ecosystem::cull()
+	{
+		Wheel<uint> culling_wheel;
+		for (auto& spc : species)
+		{
+			culling_wheel.set(spc.first, spc.second.culling_chance());
+		}
+
 		/// Cull networks until the size limit
 		/// of the ecosystem is reached.
-		while (nets.size() > cfg.ecosystem.max.size)
+		while (nets.size() > cfg.ecosystem.max.size &&
+			   !culling_wheel.empty())
 		{
 			/// Erase a network from a random species
 			/// picked from the cull roulette wheel.
-			uint net_id(species.at(cfg.w_dist(culling_wheel)).erase_net());
+			uint spc_id(cfg.w_dist(culling_wheel));
+			uint net_id(species.at(spc_id).erase_net());
 
-			if (net_id != 0 &&
-				net_id != stats.champ_id)
+			if (net_id == 0)
+			{
+				/// Nothing left to cull in this species
+				culling_wheel.erase(spc_id);
+			}
+			else if (net_id != stats.champ_id)
 			{
 				dlog() << "Erasing network " << net_id;
 				nets.erase(net_id);
@@ -252,4 +297,100 @@ namespace Cortex
 			spc.second.mutate();
 		}
 	}
+
+	bool Ecosystem::migration_due() const
+	{
+		/// The age has already been increased,
+		/// so the generation which has just been
+		/// evaluated is age - 1.
+		return (archipelago != nullptr &&
+				cfg.islands.count > 1 &&
+				cfg.islands.migrants > 0 &&
+				!cancel.cancelled() &&
+				(age - 1) % cfg.islands.interval == 0);
+	}
+
+	bool Ecosystem::archipelago_solved() const
+	{
+		return (archipelago != nullptr &&
+				archipelago->is_solved());
+	}
+
+	void Ecosystem::emigrate()
+	{
+		dlog() << "*** Sending migrants from island " << island;
+		archipelago->emigrate(island);
+	}
+
+	void Ecosystem::immigrate()
+	{
+		for (auto& migrants : archipelago->immigrate(island))
+		{
+			admit_migrants(*migrants);
+		}
+
+		/// Make room for the migrants. They keep
+		/// their fitness, so they compete with the
+		/// residents on an equal footing.
+		cull();
+	}
+
+	void Ecosystem::select_migrants(Migrants& _migrants)
+	{
+		_migrants.age = age - 1;
+
+		/// Rank the networks by fitness.
+		/// Ties are broken by ID so that the
+		/// selection does not depend on the storage order.
+		std::vector<std::pair<real, uint>> ranked;
+		for (const auto& net : nets)
+		{
+			ranked.emplace_back(net.second.get_abs_fitness(), net.first);
+		}
+
+		const uint count(std::min<uint>(cfg.islands.migrants, ranked.size()));
+		std::partial_sort(ranked.begin(),
+						  ranked.begin() + count,
+						  ranked.end(),
+						  std::greater<std::pair<real, uint>>());
+
+		for (uint i = 0; i < count; ++i)
+		{
+			Net& net(nets.at(ranked[i].second));
+
+			_migrants.species.emplace(std::piecewise_construct,
+									  std::forward_as_tuple(net.id),
+									  std::forward_as_tuple(net.id, net.species.get().get_genotype(), cfg));
+
+			_migrants.nets.emplace(std::piecewise_construct,
+								   std::forward_as_tuple(net.id),
+								   std::forward_as_tuple(net.id, *this, _migrants.species.at(net.id)));
+
+			_migrants.nets.at(net.id).clone(net);
+		}
+	}
+
+	void Ecosystem::admit_migrants(Migrants& _migrants)
+	{
+		uint admitted(0);
+		for (auto& migrant : _migrants.nets)
+		{
+			/// Place the migrant in a species with the same genotype.
+			/// The migrant is dropped if no such species exists
+			/// and no new species can be created.
+			uint spc_id(get_species_id(migrant.second.species.get().get_genotype()));
+			if (spc_id == 0)
+			{
+				continue;
+			}
+
+			uint net_id(new_net_id());
+			insert_net(net_id, spc_id);
+			nets.at(net_id).clone(migrant.second);
+			++admitted;
+		}
+
+		dlog() << "Island " << island << " admitted " << admitted << " of "
+			   << _migrants.nets.size() << " migrants from generation " << _migrants.age;
+	}
 }
@@ -2,9 +2,13 @@
 #define ECOSYSTEM_HPP
 
 #include "Net.hpp"
+#include "Dispatcher.hpp"
 
 namespace Cortex
 {
+	class Archipelago;
+	struct Migrants;
+
 	class Ecosystem
 	{
 	public:
@@ -13,19 +17,51 @@ namespace Cortex
 		/// number of evolution rounds.
 		uint age;
 
+		/// Index of the run within the experiment (starting from 1)
+		const uint run;
+
+		/// Index of the island within the archipelago
+		const uint island;
+
 		Config& cfg;
 
 	private:
 
-		/// Threadpool for evaluating networks in parallel
-		ThreadPool tp;
+		/// Threadpool for evaluating networks in parallel.
+		/// Owned by the experiment and reused across runs.
+		ThreadPool& tp;
+
+		/// The archipelago containing this ecosystem (if any)
+		Archipelago* archipelago;
+
+		/// Cancels the remaining evaluations of a generation
+		Token cancel;
+
+		/// Random number stream of this ecosystem.
+		/// Derived from the configured seed, the run index
+		/// and the island index, so each run is reproducible
+		/// regardless of how many runs are evolved concurrently.
+		Rng rng;
+
+		/// ID counters for species and networks.
+		/// Kept per ecosystem so that concurrent runs
+		/// have independent ID spaces.
+		uint last_spc_id;
+		uint last_net_id;
 
 		/// A mapping of species IDs to species objects.
 		emap<uint, Species> species;
 
+		/// Index of the species by genotype.
+		/// Each species has a unique genotype.
+		std::unordered_map<Genotype, uint, GenotypeHash> species_index;
+
 		/// A mapping of network IDs to network objects.
 		emap<uint, Net> nets;
 
+		/// Schedules the evaluation of the networks
+		Dispatcher dispatcher;
+
 //		/// Substrates which represent the layouts
 //		/// of the input and output nodes.
 //		/// For example, input nodes can be arranged into
@@ -56,7 +92,11 @@ namespace Cortex
 
 	public:
 
-		Ecosystem(Config& _cfg);
+		Ecosystem(Config& _cfg,
+				  ThreadPool& _tp,
+				  const uint _run = 1,
+				  Archipelago* _archipelago = nullptr,
+				  const uint _island = 0);
 
 		~Ecosystem();
 
@@ -67,7 +107,23 @@ namespace Cortex
 		template<typename F, typename ... Args>
 		inline void eval(F&& _f, Args&& ... _args)
 		{
+			Rng::Scope scope(rng);
+
+			/// Another island might have solved the task
+			/// (and cancelled this island) after the caller
+			/// last checked. The flag is set before the islands
+			/// are cancelled, so checking it after the reset
+			/// cannot miss a solution.
+			cancel.reset();
+			if (archipelago_solved())
+			{
+				cancel.cancel();
+				return;
+			}
+
 			dlog() << "\n------------------------"
+				   << "\nRun: " << run
+				   << "\nIsland: " << island
 				   << "\nGeneration: " << age
 				   << "\nSpecies count: " << species.size()
 				   << "\nNetwork count: " << nets.size()
@@ -77,13 +133,31 @@ namespace Cortex
 			for (uint i = 0; i < cfg.mutation.rate; ++i)
 			{
 				dlog() << "\tRound " << i + 1;
-				for (auto& net : nets)
+
+				/// Evaluate the networks in parallel.
+				/// Each network is evaluated with its own random stream.
+				/// Returns once all networks have been evaluated.
+				/// For deterministic tasks, networks which have not
+				/// changed keep the fitness from their last evaluation.
+				/// STDP changes the weights during the evaluation,
+				/// so the networks always have to be re-evaluated.
+				dispatcher.build(nets,
+								 cfg.ecosystem.sched,
+								 cfg.ecosystem.timed,
+								 tp.worker_count(),
+								 cfg.fit.deterministic && !cfg.stdp.enabled);
+				dispatcher.run(tp, [&](Net& _net)
 				{
-					tp.enqueue(std::forward<F>(_f), std::ref(net.second), std::forward<Args>(_args)...);
-				}
+					Rng::Scope scope(_net.get_rng());
+					_f(_net, _args...);
+				}, cancel);
 
-				/// Wait for all networks to be evaluated.
-				tp.wait();
+				/// The generation has been aborted (e.g., the task has been solved)
+				if (cancel.cancelled() ||
+					archipelago_solved())
+				{
+					break;
+				}
 
 				if (cfg.mutation.enabled)
 				{
@@ -105,11 +179,25 @@ namespace Cortex
 			{
 				print_champ();
 			}
-			else
+			else if (!archipelago_solved())
 			{
+				/// Migrants are selected before the population
+				/// changes and admitted after it has evolved
+				/// (cf. immigrate(), which culls it again).
+				const bool migrate(migration_due());
+				if (migrate)
+				{
+					emigrate();
+				}
+
 				/// Evolve the ecosystem
 				dlog() << "*** Evolving ecosystem";
 				evolve();
+
+				if (migrate)
+				{
+					immigrate();
+				}
 			}
 		}
 
@@ -119,17 +207,19 @@ namespace Cortex
 			return stats.solved;
 		}
 
-		inline void mark_solved(const uint _net)
+		void mark_solved(const uint _net);
+
+		/// Skip the rest of the current generation.
+		/// Evaluations which are already running
+		/// can check is_cancelled() and return early.
+		inline void abort()
 		{
-			{
-				glock lk(stats.mtx);
-				if (!stats.solved)
-				{
-					stats.champ_id = _net;
-					stats.solved = true;
-				}
-			}
-			tp.stop();
+			cancel.cancel();
+		}
+
+		inline bool is_cancelled() const
+		{
+			return cancel.cancelled();
 		}
 
 		inline uint champ_id()
@@ -221,9 +311,42 @@ namespace Cortex
 		/// Perform crossover
 		void crossover();
 
+		/// Erase unfit networks until the
+		/// ecosystem is within its size limit.
+		void cull();
+
+		/// Check if the networks should be exchanged
+		/// with the other islands in this generation.
+		bool migration_due() const;
+
+		/// True if another island has already solved the task
+		bool archipelago_solved() const;
+
+		void emigrate();
+
+		void immigrate();
+
 		/// Mutate networks which were not culled.
 		void mutate();
 
+		/// Copy the best networks for sending them to another island
+		void select_migrants(Migrants& _migrants);
+
+		/// Add copies of the networks received from another island
+		void admit_migrants(Migrants& _migrants);
+
+		friend class Archipelago;
+
+		inline uint new_spc_id()
+		{
+			return ++last_spc_id;
+		}
+
+		inline uint new_net_id()
+		{
+			return ++last_net_id;
+		}
+
 		inline void insert_net(const uint _net_id, const uint _spc_id)
 		{
 			nets.emplace(std::piecewise_construct,
@@ -236,6 +359,7 @@ namespace Cortex
 			species.emplace(std::piecewise_construct,
 							std::forward_as_tuple(_spc_id),
 							std::forward_as_tuple(_spc_id, _gen, cfg));
+			species_index.emplace(_gen, _spc_id);
 		}
 
 	};
@@ -47,6 +47,16 @@ namespace Cortex
 
 		void set_abs(const real _abs_fit);
 
+		/// Take over the statistics of another network
+		/// (cf. Net::clone()). The parameters mutated in
+		/// the last round belong to the other network,
+		/// so they are not copied.
+		inline void copy(const Fitness& _other)
+		{
+			stat = _other.stat;
+			eff = _other.eff;
+		}
+
 		inline real diff() const
 		{
 			return stat.diff;
@@ -0,0 +1,326 @@
+#include "Graph.hpp"
+#include "Node.hpp"
+
+namespace Cortex
+{
+	void Graph::insert(Node& _node)
+	{
+		_node.ord = order.size();
+		order.emplace_back(_node);
+
+		if (!free_slots.empty())
+		{
+			_node.slot = free_slots.back();
+			free_slots.pop_back();
+		}
+		else
+		{
+			_node.slot = slots++;
+		}
+
+		if (_node.slot >= words * 64)
+		{
+			/// The rows must be widened
+			stale = true;
+		}
+
+		if (!stale)
+		{
+			/// A new node can only reach itself
+			std::fill(row(_node.slot), row(_node.slot) + words, 0);
+			row(_node.slot)[_node.slot / 64] |= uint64_t(1) << (_node.slot % 64);
+		}
+	}
+
+	void Graph::erase(Node& _node)
+	{
+		/// Paths through the node disappear together with its links.
+		/// Only its ancestors (which precede it) could reach it.
+		if (!stale &&
+			_node.ord > 0)
+		{
+			refresh(_node.ord - 1, _node.slot, &_node);
+		}
+		free_slots.push_back(_node.slot);
+
+		order.erase(order.begin() + _node.ord);
+
+		/// Shift the nodes following the erased one
+		for (uint i = _node.ord; i < order.size(); ++i)
+		{
+			order[i].get().ord = i;
+		}
+	}
+
+	bool Graph::add_link(Node& _src, Node& _tgt)
+	{
+		const uint lb(_tgt.ord);
+		const uint ub(_src.ord);
+
+		/// The order is still valid
+		if (lb > ub)
+		{
+			update_closure(_src, _tgt);
+			return true;
+		}
+
+		/// Self-loop
+		if (lb == ub)
+		{
+			return false;
+		}
+
+		/// Nodes in the affected region reachable from the target.
+		/// If the source is among them, the link forms a cycle.
+		delta_f.clear();
+		if (!search_fwd(_tgt, ub, &_src))
+		{
+			reset_marks(delta_f);
+			return false;
+		}
+
+		/// Nodes in the affected region which reach the source
+		delta_b.clear();
+		search_bwd(_src, lb);
+
+		/// Reassign the positions occupied by the two sets
+		/// so that all of delta_b precedes all of delta_f.
+		/// The relative order within each set is preserved.
+		auto by_ord([](const NodeRef& _l, const NodeRef& _r)
+		{
+			return _l.get().ord < _r.get().ord;
+		});
+
+		std::sort(delta_b.begin(), delta_b.end(), by_ord);
+		std::sort(delta_f.begin(), delta_f.end(), by_ord);
+
+		positions.clear();
+		for (const auto& node : delta_b)
+		{
+			positions.push_back(node.get().ord);
+		}
+		for (const auto& node : delta_f)
+		{
+			positions.push_back(node.get().ord);
+		}
+		std::sort(positions.begin(), positions.end());
+
+		uint pos(0);
+		for (auto& node : delta_b)
+		{
+			node.get().ord = positions[pos];
+			order[positions[pos++]] = node;
+		}
+		for (auto& node : delta_f)
+		{
+			node.get().ord = positions[pos];
+			order[positions[pos++]] = node;
+		}
+
+		reset_marks(delta_b);
+		reset_marks(delta_f);
+
+		update_closure(_src, _tgt);
+
+		return true;
+	}
+
+	void Graph::update_closure(Node& _src, Node& _tgt)
+	{
+		if (stale)
+		{
+			return;
+		}
+
+		/// Everything that reaches the source
+		/// now also reaches whatever the target reaches.
+		/// Ancestors of the source precede it in the order.
+		const uint64_t* tgt_row(row(_tgt.slot));
+		for (uint i = 0; i <= _src.ord; ++i)
+		{
+			const uint slot(order[i].get().slot);
+			if (test(slot, _src.slot))
+			{
+				uint64_t* r(row(slot));
+				for (uint w = 0; w < words; ++w)
+				{
+					r[w] |= tgt_row[w];
+				}
+			}
+		}
+	}
+
+	void Graph::erase_link(Node& _src)
+	{
+		/// Nodes which reach the source can lose paths,
+		/// but the set of those nodes does not change.
+		if (!stale)
+		{
+			refresh(_src.ord, _src.slot, nullptr);
+		}
+	}
+
+	void Graph::refresh(const uint _last, const uint _slot, const Node* _skip)
+	{
+		/// The targets of each node come after it in the order.
+		/// Targets which do not reach _slot keep their rows,
+		/// and those that do have been refreshed already.
+		for (uint i = _last + 1; i-- > 0; )
+		{
+			const Node& node(order[i].get());
+			if (!test(node.slot, _slot))
+			{
+				continue;
+			}
+
+			uint64_t* r(row(node.slot));
+			std::fill(r, r + words, 0);
+			r[node.slot / 64] |= uint64_t(1) << (node.slot % 64);
+
+			for (const auto& nrole : node.links.targets.at(LT::F))
+			{
+				for (const auto& lnk : nrole.second)
+				{
+					if (&lnk.second->tgt == _skip)
+					{
+						continue;
+					}
+
+					const uint64_t* tgt_row(row(lnk.second->tgt.slot));
+					for (uint w = 0; w < words; ++w)
+					{
+						r[w] |= tgt_row[w];
+					}
+				}
+			}
+		}
+	}
+
+	bool Graph::reaches(Node& _from, Node& _to)
+	{
+		if (&_from == &_to)
+		{
+			return true;
+		}
+
+		/// Every node reachable from _from
+		/// comes after it in the order.
+		if (_from.ord > _to.ord)
+		{
+			return false;
+		}
+
+		if (stale)
+		{
+			rebuild();
+		}
+
+		return test(_from.slot, _to.slot);
+	}
+
+	void Graph::rebuild()
+	{
+		/// Rows are allocated for every slot
+		/// that fits in the current row width.
+		words = (slots + 63) / 64;
+		closure.assign(64 * words * words, 0);
+
+		/// The targets of each node come after it in the order,
+		/// so their rows are complete by the time they are needed.
+		for (uint i = order.size(); i-- > 0; )
+		{
+			const Node& node(order[i].get());
+			uint64_t* r(row(node.slot));
+			r[node.slot / 64] |= uint64_t(1) << (node.slot % 64);
+
+			for (const auto& nrole : node.links.targets.at(LT::F))
+			{
+				for (const auto& lnk : nrole.second)
+				{
+					const uint64_t* tgt_row(row(lnk.second->tgt.slot));
+					for (uint w = 0; w < words; ++w)
+					{
+						r[w] |= tgt_row[w];
+					}
+				}
+			}
+		}
+
+		stale = false;
+	}
+
+	bool Graph::search_fwd(Node& _node, const uint _ub, const Node* _stop)
+	{
+		stack.clear();
+		stack.emplace_back(_node);
+		_node.mark = Mark::Temp;
+		delta_f.emplace_back(_node);
+
+		while (!stack.empty())
+		{
+			Node& node(stack.back().get());
+			stack.pop_back();
+
+			for (const auto& nrole : node.links.targets.at(LT::F))
+			{
+				for (const auto& lnk : nrole.second)
+				{
+					Node& tgt(lnk.second->tgt);
+
+					if (&tgt == _stop)
+					{
+						return false;
+					}
+
+					if (tgt.mark == Mark::None &&
+						tgt.ord <= _ub)
+					{
+						tgt.mark = Mark::Temp;
+						delta_f.emplace_back(tgt);
+						stack.emplace_back(tgt);
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void Graph::search_bwd(Node& _node, const uint _lb)
+	{
+		stack.clear();
+		stack.emplace_back(_node);
+		_node.mark = Mark::Perm;
+		delta_b.emplace_back(_node);
+
+		while (!stack.empty())
+		{
+			Node& node(stack.back().get());
+			stack.pop_back();
+
+			for (const auto& nrole : node.links.sources.at(LT::F))
+			{
+				for (const auto& lnk : nrole.second)
+				{
+					Node& src(lnk.second.get().src);
+
+					if (src.mark == Mark::None &&
+						src.ord >= _lb)
+					{
+						src.mark = Mark::Perm;
+						delta_b.emplace_back(src);
+						stack.emplace_back(src);
+					}
+				}
+			}
+		}
+	}
+
+	void Graph::reset_marks(std::vector<NodeRef>& _nodes)
+	{
+		for (auto& node : _nodes)
+		{
+			node.get().mark = Mark::None;
+		}
+	}
+}
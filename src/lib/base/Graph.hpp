@@ -0,0 +1,129 @@
+#ifndef GRAPH_HPP
+#define GRAPH_HPP
+
+#include "Globals.hpp"
+
+namespace Cortex
+{
+	/// \brief Incrementally maintained topological order.
+	///
+	/// The order contains all nodes of a network such that
+	/// the source of every forward link precedes its target.
+	/// It is maintained with the dynamic topological sort of
+	/// Pearce and Kelly (2006): adding a forward link only
+	/// reorders the nodes whose position lies between the
+	/// target and the source of the new link, and erasing
+	/// a link does not require any reordering at all.
+	///
+	/// The graph also caches the transitive closure of the
+	/// forward links as one bitset per node, so reachability
+	/// queries (and therefore cycle checks) are O(1).
+	/// Adding a link updates the bitsets of the ancestors
+	/// of its source. Erasing a link or a node recomputes
+	/// the bitsets of the ancestors of its source (or of the
+	/// node itself) from those of their targets, visiting
+	/// them in reverse topological order. The closure is only
+	/// rebuilt from scratch when the rows have to be widened.
+	struct Graph
+	{
+		/// Nodes in topological order.
+		/// The position of each node is stored in Node::ord.
+		std::vector<NodeRef> order;
+
+		/// Append a new node to the order.
+		void insert(Node& _node);
+
+		/// Remove a node from the order.
+		/// The node should be erased from the network afterwards.
+		void erase(Node& _node);
+
+		/// Restore the order after a forward link
+		/// _src -> _tgt has been added.
+		/// Returns false if the link forms a cycle.
+		bool add_link(Node& _src, Node& _tgt);
+
+		/// Update the closure after a forward
+		/// link from _src has been erased.
+		void erase_link(Node& _src);
+
+		/// Check if _to can be reached from _from
+		/// by following forward links.
+		bool reaches(Node& _from, Node& _to);
+
+		inline uint size() const
+		{
+			return order.size();
+		}
+
+		inline void clear()
+		{
+			order.clear();
+			closure.clear();
+			free_slots.clear();
+			slots = 0;
+			words = 0;
+			stale = true;
+		}
+
+	private:
+
+		/// Transitive closure of the forward links.
+		/// Row Node::slot holds the set of slots
+		/// of the nodes reachable from that node
+		/// (including the node itself).
+		std::vector<uint64_t> closure;
+
+		/// Number of 64-bit words per row
+		uint words = 0;
+
+		/// Number of slots handed out so far
+		uint slots = 0;
+
+		/// Slots of erased nodes
+		std::vector<uint> free_slots;
+
+		/// Indicates that the closure must be rebuilt
+		bool stale = true;
+
+		/// Scratch space for the bounded searches
+		std::vector<NodeRef> stack;
+		std::vector<NodeRef> delta_f;
+		std::vector<NodeRef> delta_b;
+		std::vector<uint> positions;
+
+		/// Collect the nodes reachable from _node
+		/// whose position is at most _ub.
+		/// Returns false if _stop is among them.
+		bool search_fwd(Node& _node, const uint _ub, const Node* _stop);
+
+		/// Collect the nodes from which _node is reachable
+		/// and whose position is at least _lb.
+		void search_bwd(Node& _node, const uint _lb);
+
+		void reset_marks(std::vector<NodeRef>& _nodes);
+
+		/// Add the descendants of _tgt to the
+		/// ancestors of _src after adding _src -> _tgt.
+		void update_closure(Node& _src, Node& _tgt);
+
+		/// Recompute the rows of the nodes which reach the node
+		/// in _slot and lie at or before position _last in the order.
+		/// Links to _skip (a node being erased) are ignored.
+		void refresh(const uint _last, const uint _slot, const Node* _skip);
+
+		/// Rebuild the closure in reverse topological order
+		void rebuild();
+
+		inline uint64_t* row(const uint _slot)
+		{
+			return closure.data() + _slot * words;
+		}
+
+		inline bool test(const uint _row, const uint _slot)
+		{
+			return (row(_row)[_slot / 64] >> (_slot % 64)) & 1;
+		}
+	};
+}
+
+#endif // GRAPH_HPP
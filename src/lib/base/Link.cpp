@@ -34,29 +34,23 @@ namespace Cortex
 	}
 
 	/// Links methods
-	Links::Links()
-	{
-		/// Iterate over link types
-		for (const auto& ltype : Enum<LT>::entries)
-		{
-			for (const auto& nrole : Enum<NR>::entries)
-			{
-				/// Iterate over source-target
-				/// role pairs for this link type
-				targets[ltype.first][nrole.first] = hmap<uint, LinkPtr>();
-				sources[ltype.first][nrole.first] = hmap<uint, LinkRef>();
-			}
-		}
-	}
+	Links::Links(Arena& _arena)
+		:
+		  arena(_arena),
+		  /// One table for each source-target
+		  /// role pair and link type
+		  targets(ArenaAllocator<std::pair<const uint, LinkPtr>>(_arena)),
+		  sources(ArenaAllocator<std::pair<const uint, LinkRef>>(_arena))
+	{}
 
 	void Links::add(const LT _lt, Node& _src, Node& _tgt, Config& _cfg)
 	{
-		targets.at(_lt).at(_tgt.id.role).emplace(_tgt.id.idx, std::make_unique<Link>(_src, _tgt, _lt, _cfg));
+		targets.at(_lt).at(_tgt.id.role).emplace(_tgt.id.idx, make_arena_ptr<Link>(arena, _src, _tgt, _lt, _cfg));
 	}
 
 	void Links::add(const LT _lt, Node& _src, Node& _tgt, const Link& _other)
 	{
-		targets.at(_lt).at(_tgt.id.role).emplace(_tgt.id.idx, std::make_unique<Link>(_src, _tgt, _other));
+		targets.at(_lt).at(_tgt.id.role).emplace(_tgt.id.idx, make_arena_ptr<Link>(arena, _src, _tgt, _other));
 	}
 
 	void Links::erase(const LT _lt, const NodeID& _id)
@@ -67,51 +61,4 @@ namespace Cortex
 		/// Remove the actual link
 		targets.at(_lt).at(_id.role).erase(_id.idx);
 	}
-
-	void Links::reindex(const NodeID& _id)
-	{
-		for (auto& ltype : targets)
-		{
-			hmap<uint, LinkPtr> tmp_map;
-			for (auto it = ltype.second.at(_id.role).begin(); it != ltype.second.at(_id.role).end(); )
-			{
-				if (it->first > _id.idx)
-				{
-					tmp_map.emplace(it->first - 1, std::move(it->second));
-					it = ltype.second.at(_id.role).erase(it);
-				}
-				else
-				{
-					++it;
-				}
-			}
-
-			for (auto& lnk : tmp_map)
-			{
-				ltype.second.at(_id.role).emplace(lnk.first, std::move(lnk.second));
-			}
-		}
-
-		for (auto& ltype : sources)
-		{
-			hmap<uint, LinkRef> tmp_map;
-			for (auto it = ltype.second.at(_id.role).begin(); it != ltype.second.at(_id.role).end(); )
-			{
-				if (it->first > _id.idx)
-				{
-					tmp_map.emplace(it->first - 1, it->second);
-					it = ltype.second.at(_id.role).erase(it);
-				}
-				else
-				{
-					++it;
-				}
-			}
-
-			for (auto& lnk : tmp_map)
-			{
-				ltype.second.at(_id.role).emplace(lnk.first, lnk.second);
-			}
-		}
-	}
 }
@@ -49,18 +49,19 @@ namespace Cortex
 
 	struct Links
 	{
-		emap<LT, emap<NR, hmap<uint, LinkPtr>>> targets;
-		emap<LT, emap<NR, hmap<uint, LinkRef>>> sources;
+		/// The arena of the network which owns the links
+		Arena& arena;
 
-		Links();
+		etable<LT, etable<NR, amap<uint, LinkPtr>>> targets;
+		etable<LT, etable<NR, amap<uint, LinkRef>>> sources;
+
+		explicit Links(Arena& _arena);
 
 		void add(const LT _lt, Node& _src, Node& _tgt, Config& _cfg);
 
 		void add(const LT _lt, Node& _src, Node& _tgt, const Link& _other);
 
 		void erase(const LT _lt, const NodeID& _id);
-
-		void reindex(const NodeID& _id);
 	};
 }
 
@@ -1,5 +1,6 @@
 #include "Net.hpp"
 #include "Ecosystem.hpp"
+#include "Kernels.hpp"
 
 namespace Cortex
 {
@@ -13,13 +14,18 @@ namespace Cortex
 		  ecosystem(_ecosystem),
 		  species(_species),
 		  cfg(_ecosystem.cfg),
-		  fitness(_ecosystem.cfg)
+		  fitness(_ecosystem.cfg),
+		  rng(_ecosystem.cfg.stream()(), _id),
+		  eval_time(0.0),
+		  dirty(true)
 	{
 		for (const auto& role : Enum<NR>::entries)
 		{
 			nodes.emplace(role.first, hmap<uint, NodePtr>());
+			handles.emplace(role.first, NodeHandles());
 		}
 		_species.add_net(*this);
+		plan.delta = cfg.net.delta;
 	}
 
 	Net::~Net()
@@ -35,13 +41,15 @@ namespace Cortex
 
 	void Net::init()
 	{
+		Rng::Scope scope(rng);
+
 		/// Create the phenome by adding
 		/// nodes to the network
 		for (const auto& roles : species.get().get_genome())
 		{
 			for (uint idx = 0; idx < roles.second; ++idx)
 			{
-				NodeID node_id({roles.first, idx + 1});
+				NodeID node_id({roles.first, handles.at(roles.first).acquire()});
 				if (!insert_node(node_id))
 				{
 					dlog() << "Error inserting node " << node_id;
@@ -57,6 +65,7 @@ namespace Cortex
 	{
 		/// The default is to set the absolute fitness
 		fitness.set_abs(_fitness);
+		dirty = false;
 		ecosystem.get().inc_evals();
 		if (fitness.is_solved())
 		{
@@ -64,6 +73,11 @@ namespace Cortex
 		}
 	}
 
+	void Net::replay_fitness()
+	{
+		fitness.set_abs(fitness.get_abs());
+	}
+
 	bool Net::add_node(const NR _role)
 	{
 		/// Add a node and connect it to the network.
@@ -77,15 +91,13 @@ namespace Cortex
 			}
 
 			/// Insert a node
-			NodeID node_id({_role, node_count(_role) + 1});
+			NodeID node_id({_role, handles.at(_role).acquire()});
 			if (!insert_node(node_id))
 			{
+				handles.at(_role).release(node_id.idx);
 				return false;
 			}
 
-			/// Clear the evaluation graph
-			graph.clear();
-
 			/// Connect the node to the network
 			nodes.at(node_id.role).at(node_id.idx)->connect();
 
@@ -125,56 +137,19 @@ namespace Cortex
 			NodeID node_id({_role, cfg.rnd_key(nodes.at(_role))});
 //			dlog() << "\tErasing node " << node_id;
 
-			/// Erase the node
-			if (nodes.at(_role).erase(node_id.idx) == 0)
-			{
-				return false;
-			}
-
-			/// Clear the evaluation graph
-			graph.clear();
-
-			/// Iterate over nodes in the same role
-			/// and decrement NodeID.idx by 1 if
-			/// it is greater than the one deleted.
-			/// After that, move the node to the new
-			/// index in the lookup table.
-			hmap<uint, NodePtr> tmp_map;
-			for (auto it = nodes.at(node_id.role).begin(); it != nodes.at(node_id.role).end(); )
-			{
-				if (it->first > node_id.idx)
-				{
-					--(it->second->id.idx);
-					tmp_map.emplace(it->first - 1, std::move(it->second));
-					it = nodes.at(_role).erase(it);
-				}
-				else
-				{
-					++it;
-				}
-			}
-
-			/// Move nodes back into the node lookup table
-			for (auto& node : tmp_map)
-			{
-				nodes.at(node_id.role).emplace(node.first, std::move(node.second));
-			}
-
-			/// Reindex links
-			for (const auto& nrole : nodes)
-			{
-				for (const auto& idx : nrole.second)
-				{
-					idx.second->reindex(node_id);
-				}
-			}
+			/// Erase the node.
+			/// The handles of the other nodes
+			/// and their links remain valid.
+			graph.erase(*nodes.at(_role).at(node_id.idx));
+			nodes.at(_role).erase(node_id.idx);
+			handles.at(_role).release(node_id.idx);
 
 //			dlog() << "After erase_node():" << *this;
 
 			/// Make sure that the network is in a valid state
 			connect();
 
-			/// Regenerate the evaluation graph
+			/// Recompile the evaluation plan
 			make_graph();
 
 			/// Unregister the network from the old species
@@ -198,27 +173,19 @@ namespace Cortex
 
 		while (attempts-- > 0)
 		{
-			LT lt(cfg.w_dist(cfg.link.type));
+			LT lt(cfg.w_dist(cfg.samplers.link.type));
 			if (lt == LT::R &&
 				!cfg.link.rec)
 			{
 				lt = LT::F;
 			}
 
-			std::map<std::pair<NR, NR>, real> role_map;
-			for (const auto& srole : cfg.link.prob.at(lt))
-			{
-				for (const auto& trole : srole.second)
-				{
-					role_map[{srole.first, trole.first}] = trole.second;
-				}
-			}
-
 			/// Pick the source and target roles
+			const auto& role_dist(cfg.samplers.link.roles.at(lt));
 			std::pair<NR, NR> roles;
 			do
 			{
-				roles = cfg.w_dist(role_map);
+				roles = cfg.w_dist(role_dist);
 			} while (node_count(roles.first) == 0 || node_count(roles.second) == 0);
 
 			NodeID src_id({roles.first, cfg.rnd_key(nodes.at(roles.first))});
@@ -244,27 +211,19 @@ namespace Cortex
 
 		while (attempts-- > 0)
 		{
-			LT lt(cfg.w_dist(cfg.link.type));
+			LT lt(cfg.w_dist(cfg.samplers.link.type));
 			if (lt == LT::R &&
 				!cfg.link.rec)
 			{
 				lt = LT::F;
 			}
 
-			std::map<std::pair<NR, NR>, real> role_map;
-			for (const auto& srole : cfg.link.prob.at(lt))
-			{
-				for (const auto& trole : srole.second)
-				{
-					role_map[{srole.first, trole.first}] = trole.second;
-				}
-			}
-
 			/// Pick the source and target roles
+			const auto& role_dist(cfg.samplers.link.roles.at(lt));
 			std::pair<NR, NR> roles;
 			do
 			{
-				roles = cfg.w_dist(role_map);
+				roles = cfg.w_dist(role_dist);
 			} while (node_count(roles.first) == 0 || node_count(roles.second) == 0);
 
 			NodeID src_id({roles.first, cfg.rnd_key(nodes.at(roles.first))});
@@ -296,38 +255,12 @@ namespace Cortex
 		}
 	}
 
-	void Net::make_graph(const bool _update)
+	void Net::make_graph()
 	{
 //		dlog() << "Network " << id << ": creating graph...";
 
-		if (_update)
-		{
-			graph.clear();
-		}
-
-		reset_marks();
-
-		for (const auto& nrole : nodes)
-		{
-			for (const auto& node : nrole.second)
-			{
-				if (node.second->mark == Mark::None &&
-					!node.second->visit(_update))
-				{
-					dlog() << "Net::make_graph(): Failed to make graph for network "
-						   << id << ", exiting...\n" << *this;
-					exit(EXIT_FAILURE);
-				}
-			}
-		}
-
-		/// The graph is constructed backwards,
-		/// so we need to reverse it.
-		if (_update &&
-			!graph.empty())
-		{
-			std::reverse(graph.begin(), graph.end());
-		}
+		/// Compile the evaluation plan
+		plan.compile(graph.order, cfg.link.rec);
 	}
 
 	void Net::mark_solved()
@@ -335,6 +268,11 @@ namespace Cortex
 		ecosystem.get().mark_solved(id);
 	}
 
+	bool Net::is_cancelled() const
+	{
+		return ecosystem.get().is_cancelled();
+	}
+
 	void Net::eval(const std::vector<real>& _input)
 	{
 		switch (cfg.net.type)
@@ -353,10 +291,53 @@ namespace Cortex
 		}
 	}
 
+	void Net::eval_batch(const std::vector<real>& _input, const uint _samples, std::vector<real>& _output)
+	{
+		switch (cfg.net.type)
+		{
+		case NT::Classical:
+			plan.eval_batch(_input, _samples, _output);
+			break;
+
+		case NT::Spiking:
+			/// The whole batch is encoded at once,
+			/// and the samples are simulated one at a time.
+			if (cfg.net.rf == RF::GRF)
+			{
+				check_grf(_input.size(), _samples);
+				eval_batch(*cfg.grf.share(_input, _samples, cfg.net.spiking.max.latency), _output);
+			}
+			else
+			{
+				encode(_input, _samples);
+				simulate(latency.data(), _samples, _output);
+			}
+			break;
+
+		default:
+			dlog() << "Invalid network type " << as_str<NT>(cfg.net.type);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	void Net::eval_batch(const GRF::Batch& _batch, std::vector<real>& _output)
+	{
+		if (cfg.net.type != NT::Spiking ||
+			_batch.latency.size() != _batch.samples * plan.in_count)
+		{
+			dlog() << "Net::eval_batch(): Batch does not match network " << id;
+			exit(EXIT_FAILURE);
+		}
+
+		simulate(_batch.latency.data(), _batch.samples, _output);
+	}
+
 	void Net::mutate()
 	{
+		Rng::Scope scope(rng);
+
 		/// Determine the type of mutation to perform.
-		auto mut_prob(cfg.mutation.prob);
+		const Sampler<Mut>* mut_prob(&cfg.samplers.mutation.prob);
 
 		/// The next procedure tries to make sure that
 		/// we are not going to end up with an ecosystem
@@ -366,25 +347,33 @@ namespace Cortex
 		///	before resorting to the addition of a new hidden node.
 		if (cfg.mutation.adaptive)
 		{
+			/// The adjusted table is reused between calls
+			/// so that rebuilding it does not allocate.
+			static thread_local Sampler<Mut> mut_dist;
+			mut_dist = cfg.samplers.mutation.prob;
+
 			real sat( saturation() );
 			/// Low saturation => low probability
 			/// of adding or erasing a node or
 			/// erasing a link
-			mut_prob.at(Mut::AddNode) *= sat;
-			mut_prob.at(Mut::EraseNode) *= sat;
-			mut_prob.at(Mut::EraseLink) *= sat;
+			mut_dist.scale(Mut::AddNode, sat);
+			mut_dist.scale(Mut::EraseNode, sat);
+			mut_dist.scale(Mut::EraseLink, sat);
 
 			/// Low saturation => high probability of adding a link
-			mut_prob.at(Mut::AddLink) *= (1.0 - sat);
+			mut_dist.scale(Mut::AddLink, 1.0 - sat);
 
+			mut_dist.rebuild();
+			mut_prob = &mut_dist;
 		}
 
-		while (!mutate(cfg.w_dist(mut_prob))) {};
+		while (!mutate(cfg.w_dist(*mut_prob))) {};
 	}
 
 	bool Net::mutate(const Mut _mut)
 	{
 //		dlog() << "Mutating network " << id << ": " << _mut;
+		bool mutated(false);
 		switch (_mut)
 		{
 		case Mut::Weight:
@@ -394,33 +383,53 @@ namespace Cortex
 				NR role(NR::Undef);
 				do
 				{
-					role = cfg.w_dist(cfg.mutation.node);
+					role = cfg.w_dist(cfg.samplers.mutation.node);
 				} while (node_count(role) == 0);
 
 //				dlog() << "\tRole: " << role;
 
-				return nodes.at(role).at(cfg.rnd_key(nodes.at(role)))->mutate(_mut);
+				Node& node(*nodes.at(role).at(cfg.rnd_key(nodes.at(role))));
+				if (node.mutate(_mut))
+				{
+					/// Pick up the new parameter values
+					plan.sync(node);
+					mutated = true;
+				}
+				break;
 			}
 
 		case Mut::AddLink:
-			return add_link();
+			mutated = add_link();
+			break;
 
 		case Mut::EraseLink:
-			return erase_link();
+			mutated = erase_link();
+			break;
 
 		case Mut::AddNode:
-			return add_node();
+			mutated = add_node();
+			break;
 
 		case Mut::EraseNode:
-			return erase_node();
+			mutated = erase_node();
+			break;
 
 		default:
-			return false;
+			break;
+		}
+
+		if (mutated)
+		{
+			/// The last fitness no longer applies
+			dirty = true;
 		}
+		return mutated;
 	}
 
 	void Net::crossover(Net& _p1, Net& _p2)
 	{
+		Rng::Scope scope(rng);
+
 		/// Relative fitness scores of the two parents.
 		hmap<uint, real> fdist;
 		fdist.emplace(_p1.id, _p1.get_abs_fitness());
@@ -433,12 +442,19 @@ namespace Cortex
 //			   << _p1 << "\n\n" << _p2 << "\n"
 //			   << "Replicating nodes...";
 
+		/// Match the nodes of the two parents
+		Alignment al(_p1.align(_p2));
+
+		/// The offspring inherits the node handles of parent 1
+		handles = _p1.handles;
+
 		/// Create the nodes
 		for (const auto& nrole : _p1.nodes)
 		{
 			for (const auto& idx : nrole.second)
 			{
-				if (!insert_node(cfg.w_dist(fdist) == _p1.id ? *idx.second : _p2.get_node(idx.second->id)))
+				NodeID p2_id{nrole.first, al.fwd.at(nrole.first).at(idx.first)};
+				if (!insert_node(idx.second->id, cfg.w_dist(fdist) == _p1.id ? *idx.second : _p2.get_node(p2_id)))
 				{
 					dlog() << "Net::crossover(): node replication failed!";
 					exit(EXIT_FAILURE);
@@ -453,7 +469,8 @@ namespace Cortex
 		{
 			for (const auto& idx : nrole.second)
 			{
-				idx.second->crossover(_p1.get_node(idx.second->id), _p2.get_node(idx.second->id), fdist);
+				NodeID p2_id{nrole.first, al.fwd.at(nrole.first).at(idx.first)};
+				idx.second->crossover(_p1.get_node(idx.second->id), _p2.get_node(p2_id), al, fdist);
 			}
 		}
 
@@ -463,6 +480,83 @@ namespace Cortex
 //		dlog() << "Offspring:\n" << *this << "\n";
 	}
 
+	void Net::clone(Net& _other)
+	{
+		/// The copy has the same node handles
+		handles = _other.handles;
+
+		for (const auto& nrole : _other.nodes)
+		{
+			for (const auto& idx : nrole.second)
+			{
+				if (!insert_node(idx.second->id, *idx.second))
+				{
+					dlog() << "Net::clone(): node replication failed!";
+					exit(EXIT_FAILURE);
+				}
+			}
+		}
+
+		for (const auto& nrole : _other.nodes)
+		{
+			for (const auto& idx : nrole.second)
+			{
+				get_node(idx.second->id).clone(*idx.second);
+			}
+		}
+
+		make_graph();
+
+		fitness.copy(_other.fitness);
+		eval_time = _other.eval_time;
+		dirty = _other.dirty;
+	}
+
+	Alignment Net::align(const Net& _other) const
+	{
+		Alignment al;
+
+		std::vector<uint> mine;
+		std::vector<uint> theirs;
+
+		for (const auto& nrole : nodes)
+		{
+			mine.clear();
+			theirs.clear();
+
+			for (const auto& idx : nrole.second)
+			{
+				mine.push_back(idx.first);
+			}
+
+			for (const auto& idx : _other.nodes.at(nrole.first))
+			{
+				theirs.push_back(idx.first);
+			}
+
+			if (mine.size() != theirs.size())
+			{
+				dlog() << "Net::align(): Networks " << id << " and " << _other.id
+					   << " have different numbers of " << nrole.first << " nodes";
+				exit(EXIT_FAILURE);
+			}
+
+			/// The position of a node is its rank in handle order
+			std::sort(mine.begin(), mine.end());
+			std::sort(theirs.begin(), theirs.end());
+
+			auto& fwd(al.fwd[nrole.first]);
+			auto& bwd(al.bwd[nrole.first]);
+			for (uint pos = 0; pos < mine.size(); ++pos)
+			{
+				fwd.emplace(mine[pos], theirs[pos]);
+				bwd.emplace(theirs[pos], mine[pos]);
+			}
+		}
+
+		return al;
+	}
+
 	////// Classical nets
 
 	/// Experimental!
@@ -516,193 +610,155 @@ namespace Cortex
 
 	////// Spiking nets
 
-	void Net::stdp_post_spike()
+	/// Multiplicative Hebbian plasticity.
+	/// Adapted from Rubin, Lee & Sompolinsky (2000),
+	/// Equilibrium Properties Of Temporally Asymmetric Hebbian Plasticity.
+	/// The magnitude of the weight is potentiated towards
+	/// the maximal weight or depressed towards 0, and
+	/// the sign of the weight is preserved.
+	/// The rate is capped at 1 so that a large trace
+	/// cannot push the weight past either bound.
+	static inline real potentiate(const real _w, const real _max, const real _rate)
 	{
-//		real cur_time(scheduler.top().first);
-//		uint src(scheduler.top().second.first);
-//		uint tgt(scheduler.top().second.second);
+		const real mag(std::fabs(_w));
+		return std::copysign(mag + std::min<real>(_rate, 1.0) * (_max - mag), _w);
+	}
 
-//		real tgt_last_spike_time( nodes_old.at(tgt).get_last_spike_time() );
+	static inline real depress(const real _w, const real _rate)
+	{
+		return _w - std::min<real>(_rate, 1.0) * _w;
+	}
 
-//		if (tgt_last_spike_time > 0)
-//		{
-//			real w(link(src, tgt).get(Mut::Weight));
-//			real decay( std::exp( (tgt_last_spike_time - cur_time) / cfg.stdp.span ) );
+	void Net::stdp_pre_spike(const uint _node, const real _time)
+	{
+		const uint fwd_count(plan.all.fwd.src.size());
 
-//			/// \todo Make the decay cutoff a parameter
-//			if (decay > 0.05)
-//			{
-//				switch (cfg.stdp.type)
-//				{
-//				case STDP::Heb:
-//					{
-//						real dw(cfg.stdp.lr * decay * cfg.stdp.alpha * std::abs(w));
+		auto update([&](const uint _src, const uint _link)
+		{
+			/// Bias nodes do not take part in the plasticity
+			if (plan.nodes[_src].get().id.role == NR::B)
+			{
+				return;
+			}
 
-//						if (w >= 0)
-//						{
-//							link(src, tgt).set(Mut::Weight, w - dw);
-//						}
-//						else
-//						{
-//							link(src, tgt).set(Mut::Weight, w + dw);
-//						}
+			const real trace(stdp_trace(_src, _time));
+			const real w(plan.link_weight(_link));
 
-//						break;
-//					}
+			switch (cfg.stdp.type)
+			{
+			case STDP::Heb:
+				plan.set_weight(_link, potentiate(w, cfg.link.weight.max, cfg.stdp.lr * trace));
+				break;
 
-//				case STDP::AntiHeb:
-//					{
-//						real dw(cfg.stdp.lr * decay * (cfg.link.params[Mut::Weight].max - std::abs(w)));
+			case STDP::AntiHeb:
+				plan.set_weight(_link, depress(w, cfg.stdp.lr * cfg.stdp.alpha * trace));
+				break;
 
-//						if (w >= 0)
-//						{
-//							link(src, tgt).set(Mut::Weight, std::abs(w) + dw);
-//						}
-//						else
-//						{
-//							link(src, tgt).set(Mut::Weight, std::abs(w) - dw);
-//						}
+			default:
+				break;
+			}
+		});
 
-//						break;
-//					}
+		for (uint l = plan.all.fwd.offset[_node]; l < plan.all.fwd.offset[_node + 1]; ++l)
+		{
+			update(plan.all.fwd.src[l], l);
+		}
 
-//				default:
-//					break;
-//				}
-//			}
-//		}
+		for (uint l = plan.all.rec.offset[_node]; l < plan.all.rec.offset[_node + 1]; ++l)
+		{
+			update(plan.all.rec.src[l], fwd_count + l);
+		}
 	}
 
-	void Net::stdp_pre_spike()
+	void Net::stdp_post_spike(const uint _node, const real _time)
 	{
-//		real cur_time(scheduler.top().first);
-//		uint tgt(scheduler.top().second.second);
-//		std::priority_queue<event, std::vector<event>> spike_times;
-
-//		for (const uint src : phenome.get(LT::S, tgt))
-//		{
-//			if (nodes_old.at(src).get_role() != NR::B)
-//			{
-//				real src_last_spike_time( nodes_old.at(src).get_last_spike_time() );
-
-//				if (src_last_spike_time > 0.0 &&
-//					src_last_spike_time + link(src, tgt).get(Mut::Delay) <= cur_time)
-//				{
-//					spike_times.emplace(src_last_spike_time, src);
-//				}
-//			}
-//		}
-
-//		while (!spike_times.empty())
-//		{
-//			real spike_time(spike_times.top().first);
-//			spike_times.pop();
-
-//			uint src(spike_times.top().second);
-//			real w( std::fabs( link(src, tgt).get(Mut::Weight) ) );
-//			real decay( std::exp( (spike_time - cur_time) / cfg.stdp.span ) );
+		if (plan.nodes[_node].get().id.role == NR::B)
+		{
+			return;
+		}
 
-//			//							std::cout << "Afferent spike time: " << aff_spike_time << ", hebbian learning for link " << afferent_spikes.top().second << "->" << target_id << std::endl;
-//			//						std::cout << "(s) diff: " << aff_spike_time - current_time << ", decay: " << decay << std::endl;
-//			//						std::cin.get();
-//			if (decay > 0.05)
-//			{
-//				switch (cfg.stdp.type)
-//				{
-//				case STDP::Heb:
-//					link(src, tgt).set(Mut::Weight, w + cfg.stdp.lr * (cfg.link.params[Mut::Weight].max - w) * decay);
-//					break;
+		for (uint l = plan.out.offset[_node]; l < plan.out.offset[_node + 1]; ++l)
+		{
+			const real trace(stdp_trace(plan.out.tgt[l], _time));
+			const real w(plan.out_weight(l));
 
-//				case STDP::AntiHeb:
-//					link(src, tgt).set(Mut::Weight, w - cfg.stdp.lr * cfg.stdp.alpha * w * decay);
-//					break;
+			switch (cfg.stdp.type)
+			{
+			case STDP::Heb:
+				plan.set_weight(plan.out.link[l], depress(w, cfg.stdp.lr * cfg.stdp.alpha * trace));
+				break;
 
-//				default:
-//					break;
-//				}
-//			}
+			case STDP::AntiHeb:
+				plan.set_weight(plan.out.link[l], potentiate(w, cfg.link.weight.max, cfg.stdp.lr * trace));
+				break;
 
-//		}
+			default:
+				break;
+			}
+		}
 	}
 
-	void Net::setup_grf(const std::vector<std::pair<real, real> >& _var_ranges)
+	bool Net::activate(const event_pair& _e)
 	{
-//		uint N( node_count(NR::I) / _var_ranges.size() );
-//		uint id( species.get().get_ids(NR::I).front() );
+		const uint tgt(plan.out.tgt[_e.second.second]);
 
-//		for (uint var = 0; var < _var_ranges.size(); ++var)
-//		{
-//			for (uint i = 0; i < N; ++i)
-//			{
-//				nodes_old.at(id).set_grf(N,
-//										 i,
-//										 cfg.net.spiking.beta,
-//										 _var_ranges[var].first,
-//										 _var_ranges[var].second);
-//				grf[var].insert(id);
-//				++id;
-//			}
-//		}
+		if (plan.nodes[tgt].get().eval(_e.first, plan.out_weight(_e.second.second)))
+		{
+			fire(tgt, _e.first);
+			return true;
+		}
+
+		return false;
 	}
 
-	bool Net::activate(const event_pair& _e)
+	void Net::fire(const uint _node, const real _time)
 	{
-//		nodes_old.at(_e.second.second).eval(_e.first, links.at(_e.second.first).at(_e.second.second).get(Mut::Weight));
-//		if (nodes_old.at(_e.second.second).get_output() > 0.0)
-//		{
-//			/// Schedule the targets *of the target* for evaluation.
-//			for (const uint tgt : phenome.get(LT::F, _e.second.second))
-//			{
-//				scheduler.emplace( event_pair(_e.first + links.at(_e.second.second).at(tgt).get(Mut::Delay), {_e.second.second, tgt}) );
-//			}
-
-//			if (cfg.link.rec.enabled)
-//			{
-//				for (const uint tgt : phenome.get(LT::R, _e.second.second))
-//				{
-//					scheduler.emplace( event_pair(_e.first + links.at(_e.second.second).at(tgt).get(Mut::Delay), {_e.second.second, tgt}) );
-//				}
-//			}
+		plan.nodes[_node].get().set_last_spike_time(_time);
 
+		if (plan.output[_node] < 0.0)
+		{
+			plan.output[_node] = _time;
+		}
 
-//			/// Multiplicative Hebbian plasticity.
-//			/// Adapted from Rubin, Lee & Sompolinsky (2000),
-//			/// Equilibrium Properties Of Temporally Asymmetric Hebbian Plasticity
-//			if (cfg.stdp.enabled)
-//			{
-//				stdp_pre_spike();
-//			}
-//		}
-//		else if (cfg.stdp.enabled)
-//		{
-//			stdp_post_spike();
-//		}
+		/// Schedule the targets of the node for evaluation.
+		const real arrival(_time + cfg.net.spiking.delay);
+		for (uint l = plan.out.offset[_node]; l < plan.out.offset[_node + 1]; ++l)
+		{
+			scheduler.push(event_pair(arrival, {_node, l}));
+		}
 
-//		return nodes_old.at(_e.second.second).get_output() > 0.0;
-		return true;
+		if (cfg.stdp.enabled)
+		{
+			stdp_pre_spike(_node, _time);
+			stdp_post_spike(_node, _time);
+			add_trace(_node, _time);
+		}
 	}
 
-	void Net::add_input(const std::vector<real>& _input)
+	void Net::encode(const std::vector<real>& _input, const uint _samples)
 	{
+		const real max_latency(cfg.net.spiking.max.latency);
+
 		switch (cfg.net.rf)
 		{
-		case RF::GRF:
-//			for (uint var = 0; var < _input.size(); ++var)
-//			{
-//				for (const uint n_id : grf[var])
-//				{
-//					nodes_old.at(n_id).set_last_spike_time(nodes_old.at(n_id).get_grf_delay(_input[var]) * cfg.net.spiking.max.latency);
-//				}
-//			}
+		case RF::Undef:
+			latency.resize(_samples * plan.in_count);
+			for (uint i = 0; i < latency.size(); ++i)
+			{
+				const real response(std::min<real>(std::max<real>(_input.at(i), 0.0), 1.0));
+				latency[i] = (1.0 - response) * max_latency;
+			}
 			break;
 
-		case RF::ARF:
-			//				add_input_arf(std::forward<const std::vector<real>&>(_input));
+		case RF::GRF:
+			check_grf(_input.size(), _samples);
+			cfg.grf.encode(_input, _samples, max_latency, latency);
 			break;
 
+		case RF::ARF:
 		case RF::ST:
-			//				add_input_st(std::forward<const std::vector<real>&>(_input));
-			break;
+			dlog() << "Receptive field type " << cfg.net.rf << " is not implemented";
+			exit(EXIT_FAILURE);
 
 		default:
 			dlog() << "Invalid receptive field type " << cfg.net.rf;
@@ -710,11 +766,88 @@ namespace Cortex
 		}
 	}
 
+	void Net::check_grf(const uint _size, const uint _samples) const
+	{
+		if (cfg.grf.size() != plan.in_count)
+		{
+			dlog() << "Receptive fields have not been set up (cf. Config::setup_grf())";
+			exit(EXIT_FAILURE);
+		}
+
+		if (_size < _samples * cfg.grf.vars())
+		{
+			dlog() << "Expected " << cfg.grf.vars() << " variables per sample";
+			exit(EXIT_FAILURE);
+		}
+	}
+
 	std::queue<event> Net::eval_spiking(const std::vector<real>& _input)
 	{
-//		reset();
+		encode(_input, 1);
+		return simulate(latency.data());
+	}
 
-		add_input(_input);
+	void Net::simulate(const real* _latency, const uint _samples, std::vector<real>& _output)
+	{
+		const uint out_count(plan.outputs.size());
+		_output.resize(_samples * out_count);
+
+		for (uint s = 0; s < _samples; ++s)
+		{
+			simulate(_latency + s * plan.in_count);
+			for (uint o = 0; o < out_count; ++o)
+			{
+				_output[s * out_count + o] = plan.output[plan.outputs[o]];
+			}
+		}
+	}
+
+	std::queue<event> Net::simulate(const real* _latency)
+	{
+		/// Start from rest
+		for (auto& node : plan.nodes)
+		{
+			node.get().reset();
+		}
+		std::fill(plan.output.begin(), plan.output.end(), -1.0);
+
+		if (cfg.stdp.enabled)
+		{
+			traces.value.assign(plan.size(), 0.0);
+			traces.time.assign(plan.size(), 0.0);
+		}
+
+		/// Input nodes spike after their latencies
+		/// and bias nodes at the start.
+		stimuli.clear();
+		for (uint i = 0; i < plan.size(); ++i)
+		{
+			if (plan.ext[i] != Plan::none)
+			{
+				stimuli.emplace_back(_latency[plan.ext[i]], i);
+			}
+			else if (plan.nodes[i].get().id.role == NR::B)
+			{
+				stimuli.emplace_back(0.0, i);
+			}
+		}
+
+		if (cfg.net.spiking.sim == Sim::Clock)
+		{
+			return eval_clock();
+		}
+
+		/// Input spikes arrive at their targets within
+		/// the maximal latency plus one link delay.
+		const real horizon(cfg.net.spiking.max.latency + cfg.net.spiking.delay);
+		scheduler.reset(horizon, std::max<real>(cfg.net.spiking.delay, horizon / 256.0));
+
+		/// Input spikes are queued with the other events so that
+		/// all spikes (and plasticity) are processed in time order.
+		for (const auto& s : stimuli)
+		{
+			scheduler.push(event_pair(s.first, {s.second, Plan::none}));
+		}
 
 		switch (cfg.net.spiking.enc)
 		{
@@ -734,17 +867,150 @@ namespace Cortex
 	{
 		std::queue<event> spikes;
 
-//		while (!scheduler.empty())
-//		{
-//			/// Event pair: spike time | source | target
-//			if ( activate(scheduler.top()) &&
-//				 is_output(scheduler.top().second.second) )
-//			{
-//				spikes.emplace( event(scheduler.top().first, scheduler.top().second.second) );
-//			}
+		const real end(spiking_window());
 
-//			scheduler.pop();
-//		}
+		uint silent(plan.outputs.size());
+
+		while (!scheduler.empty() &&
+			   silent > 0)
+		{
+			/// Event pair: spike time | source | link
+			const event_pair e(scheduler.top());
+			if (e.first > end)
+			{
+				break;
+			}
+			scheduler.pop();
+
+			/// Input or bias node spike
+			if (e.second.second == Plan::none)
+			{
+				fire(e.second.first, e.first);
+				continue;
+			}
+
+			const uint tgt(plan.out.tgt[e.second.second]);
+			const bool first(plan.output[tgt] < 0.0);
+
+			if (activate(e) &&
+				plan.nodes[tgt].get().id.role == NR::O)
+			{
+				spikes.emplace(event(e.first, plan.nodes[tgt].get().id.idx));
+				if (first)
+				{
+					--silent;
+				}
+			}
+		}
+
+		return spikes;
+	}
+
+	std::queue<event> Net::eval_clock()
+	{
+		std::queue<event> spikes;
+
+		const uint count(plan.size());
+		const real dt(cfg.net.spiking.timestep);
+
+		/// Delay in steps
+		const uint lag(std::max<uint>(std::lround(cfg.net.spiking.delay / dt), 1));
+		const uint slots(lag + 1);
+		const uint steps(std::ceil(spiking_window() / dt));
+
+		/// The decay is only recomputed for
+		/// nodes whose time constant has changed.
+		clock.al.assign(count, 0.0);
+		clock.tau.resize(count, 0.0);
+		clock.decay.resize(count, 1.0);
+		for (uint i = 0; i < count; ++i)
+		{
+			const real tau(plan.nodes[i].get().tau.val());
+			if (tau != clock.tau[i])
+			{
+				clock.tau[i] = tau;
+				clock.decay[i] = (cfg.node.lif ? std::exp(-dt / tau) : 1.0);
+			}
+		}
+		clock.ring.assign(slots * count, 0.0);
+		clock.spikes.resize(count);
+
+		std::sort(stimuli.begin(), stimuli.end());
+		uint next(0);
+
+		uint silent(plan.outputs.size());
+
+		for (uint step = 0; step <= steps && silent > 0; ++step)
+		{
+			uint fired(Kernels::integrate(clock.al.data(),
+										  clock.decay.data(),
+										  &clock.ring[(step % slots) * count],
+										  count,
+										  clock.spikes.data()));
+
+			/// Input and bias nodes spike in the
+			/// step which contains their spike time.
+			const uint spiked(fired);
+			for (; next < stimuli.size() && stimuli[next].first < (step + 1) * dt; ++next)
+			{
+				const uint node(stimuli[next].second);
+				if (std::find(clock.spikes.begin(), clock.spikes.begin() + spiked, node) == clock.spikes.begin() + spiked)
+				{
+					clock.al[node] = 0.0;
+					clock.spikes[fired++] = node;
+				}
+			}
+
+			const real time(step * dt);
+			real* arrival(&clock.ring[((step + lag) % slots) * count]);
+
+			for (uint s = 0; s < fired; ++s)
+			{
+				const uint node(clock.spikes[s]);
+				plan.nodes[node].get().set_last_spike_time(time);
+
+				if (plan.nodes[node].get().id.role == NR::O)
+				{
+					spikes.emplace(event(time, plan.nodes[node].get().id.idx));
+					if (plan.output[node] < 0.0)
+					{
+						--silent;
+					}
+				}
+
+				if (plan.output[node] < 0.0)
+				{
+					plan.output[node] = time;
+				}
+
+				for (uint l = plan.out.offset[node]; l < plan.out.offset[node + 1]; ++l)
+				{
+					arrival[plan.out.tgt[l]] += plan.out_weight(l);
+				}
+			}
+
+			/// Plasticity is applied after the spikes of the step have
+			/// been sent, and spikes in the same step do not see each other.
+			if (cfg.stdp.enabled)
+			{
+				for (uint s = 0; s < fired; ++s)
+				{
+					stdp_pre_spike(clock.spikes[s], time);
+					stdp_post_spike(clock.spikes[s], time);
+				}
+
+				for (uint s = 0; s < fired; ++s)
+				{
+					add_trace(clock.spikes[s], time);
+				}
+			}
+		}
+
+		/// Keep the nodes in line with the simulation
+		for (uint i = 0; i < count; ++i)
+		{
+			plan.nodes[i].get().al = clock.al[i];
+		}
 
 		return spikes;
 	}
@@ -761,7 +1027,7 @@ namespace Cortex
 
 		_strm << "\n\nEvaluation order: ";
 
-		for (const auto& node : _net.graph)
+		for (const auto& node : _net.graph.order)
 		{
 			_strm << node.get().id << " ";
 		}
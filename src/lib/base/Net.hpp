@@ -6,6 +6,11 @@
 //#include "Phenome.hpp"
 #include "Node.hpp"
 #include "Link.hpp"
+#include "Graph.hpp"
+#include "Plan.hpp"
+#include "Scheduler.hpp"
+
+#include <cassert>
 
 namespace Cortex
 {
@@ -27,47 +32,129 @@ namespace Cortex
 		/// The	containing ecosystem
 		EcosystemRef ecosystem;
 
+		/// Storage for the nodes and links of this network.
+		/// Declared before the nodes so that it outlives them.
+		Arena arena;
+
 		/// Nodes organised by node role
 		emap<NR, hmap<uint, NodePtr>> nodes;
 
-		/// Evaluation graph
-		std::vector<NodeRef> graph;
+		/// Node handles organised by node role
+		emap<NR, NodeHandles> handles;
+
+		/// Evaluation graph (topological order)
+		Graph graph;
+
+		/// Compiled evaluation plan
+		Plan plan;
 
 		/// Fitness statistics
 		Fitness fitness;
 
+		/// Random number stream of this network.
+		/// Activated whenever the network is being built,
+		/// mutated or evaluated, so the outcome does not
+		/// depend on the order in which the threads run.
+		Rng rng;
+
+		/// Duration of the last evaluation.
+		/// Used for scheduling the evaluations.
+		real eval_time;
+
+		/// Indicates that the network has changed
+		/// since its fitness was last set.
+		bool dirty;
+
 		/// A scheduler which holds information about
 		/// which nodes should be evaluated at what time.
-		/// The entries are events representing a timestamp
-		/// and the pair of node IDs which have to be evaluated.
+		/// The entries are events representing the arrival
+		/// time of a spike, the node which emitted it and
+		/// the link it travels along (cf. Plan::out).
 		Scheduler scheduler;
 
-		/// Gaussian receptive fields.
-		/// \todo Generic RF class
-		hmap<uint, hset<uint>> grf;
+		/// Spike traces for STDP, indexed by position in the plan.
+		/// A trace jumps by 1 when the node spikes and decays
+		/// exponentially with time constant stdp.span, so the
+		/// effect of all earlier spikes of a node is available
+		/// in O(1) time (Morrison, Diesmann & Gerstner, 2008).
+		struct
+		{
+			/// Value at the time of the last update
+			std::vector<real> value;
 
-		inline void eval_classical(const std::vector<real>& _input)
+			std::vector<real> time;
+		} traces;
+
+		/// Spikes of the input and bias nodes (time and plan index)
+		/// which start a spiking evaluation.
+		std::vector<event> stimuli;
+
+		/// Spike latencies of the input nodes for the
+		/// current batch, (samples x input nodes) row-major.
+		/// Only used for input which is not shared with
+		/// other networks (cf. GRF::share()).
+		std::vector<real> latency;
+
+		/// State of the clock-driven simulation,
+		/// indexed by position in the plan.
+		struct
 		{
-			/// Present the input to the network
-			uint idx(0);
-			for (const auto& node : nodes.at(NR::I))
-			{
-				node.second->add_input(_input.at(idx));
-				++idx;
-			}
+			/// Activation levels
+			std::vector<real> al;
 
-			/// Propagate
-			for (auto& node : graph)
-			{
-				node.get().propagate();
-			}
+			/// Membrane time constants and the corresponding
+			/// decay of the activation level in one time step
+			std::vector<real> tau;
+			std::vector<real> decay;
+
+			/// Delay line: the input arriving at each node
+			/// in each of the next few time steps
+			std::vector<real> ring;
+
+			/// Nodes which spiked in the current step
+			std::vector<uint> spikes;
+		} clock;
+
+		inline void eval_classical(const std::vector<real>& _input)
+		{
+			plan.eval(_input);
 		}
 
+		/// Simulate the network for one input.
+		/// The output of each node is the time of its first spike
+		/// (or -1 if it has not spiked). Returns the spikes of
+		/// the output nodes (time and node index) in time order.
 		std::queue<event> eval_spiking(const std::vector<real>& _input);
 
+		/// Simulate the network for one sample given the
+		/// latencies of the input nodes (in input order).
+		std::queue<event> simulate(const real* _latency);
+
+		/// Simulate the network for a row-major
+		/// (samples x input nodes) matrix of latencies.
+		void simulate(const real* _latency, const uint _samples, std::vector<real>& _output);
+
 		/// Evaluation using exact latencies.
+		/// Events are processed in time order until every output
+		/// has spiked or until the longest chain of spikes that
+		/// can pass through each node once has run out.
 		std::queue<event> eval_latency();
 
+		/// Evaluation in fixed time steps (net.spiking.timestep).
+		/// The activation levels of all nodes are updated in each
+		/// step, and spikes reach their targets after the link
+		/// delay rounded to a whole number of steps (at least one).
+		/// Spike times are multiples of the time step.
+		/// The stopping criteria are the same as for eval_latency().
+		std::queue<event> eval_clock();
+
+		/// Time after which a spiking evaluation stops.
+		/// Recurrent links can keep the network spiking indefinitely.
+		inline real spiking_window() const
+		{
+			return cfg.net.spiking.max.latency + plan.size() * cfg.net.spiking.delay;
+		}
+
 		/// Input: a vector of real values.
 		/// Evaluated using receptive fields.
 		std::queue<event> eval_rank_order()
@@ -92,39 +179,32 @@ namespace Cortex
 			return (2.0 * link_count()) / (std::pow(node_count(), 2) - node_count());
 		}
 
-		inline uint link_count() const
-		{
-			/// Sum links
-			return std::accumulate(nodes.begin(),
-								   nodes.end(),
-								   0,
-								   [&](uint _sum, const auto& _role)
-			{
-				return _sum + std::accumulate(_role.second.begin(),
-											  _role.second.end(),
-											  0,
-											  [&](uint _link_sum, const auto& _node)
-				{
-					return _link_sum + _node.second->link_count();
-				});
-			});
-		}
-
 		inline bool insert_node (const NodeID& _id)
 		{
 			auto success(nodes.at(_id.role).emplace(_id.idx,
-													std::make_unique<Node>(_id, *this)));
+													make_arena_ptr<Node>(arena, _id, *this)));
+			if (success.second)
+			{
+				graph.insert(*success.first->second);
+			}
 			return success.second;
 		}
 
-		inline bool insert_node(Node& _other)
+		inline bool insert_node(const NodeID& _id, Node& _other)
 		{
-			auto success(nodes.at(_other.id.role).emplace(_other.id.idx,
-														  std::make_unique<Node>(_other, *this)));
-
+			auto success(nodes.at(_id.role).emplace(_id.idx,
+													make_arena_ptr<Node>(arena, _id, _other, *this)));
+			if (success.second)
+			{
+				graph.insert(*success.first->second);
+			}
 			return success.second;
 		}
 
+		/// Match the nodes of this network
+		/// with those of another network with the same genotype.
+		Alignment align(const Net& _other) const;
+
 		friend class Node;
 
 	public:
@@ -159,6 +239,48 @@ namespace Cortex
 			return nodes.at(_role).size();
 		}
 
+		inline uint link_count() const
+		{
+			/// Sum links
+			return std::accumulate(nodes.begin(),
+								   nodes.end(),
+								   0,
+								   [&](uint _sum, const auto& _role)
+			{
+				return _sum + std::accumulate(_role.second.begin(),
+											  _role.second.end(),
+											  0,
+											  [&](uint _link_sum, const auto& _node)
+				{
+					return _link_sum + _node.second->link_count();
+				});
+			});
+		}
+
+		/// Duration of the last evaluation (in seconds).
+		/// 0 if the network has not been evaluated yet.
+		inline real get_eval_time() const
+		{
+			return eval_time;
+		}
+
+		inline void set_eval_time(const real _time)
+		{
+			eval_time = _time;
+		}
+
+		/// True if the network has been created or mutated
+		/// since the last evaluation.
+		inline bool is_dirty() const
+		{
+			return dirty;
+		}
+
+		inline Rng& get_rng()
+		{
+			return rng;
+		}
+
 		inline const real get_abs_fitness() const
 		{
 			return fitness.get_abs();
@@ -166,6 +288,13 @@ namespace Cortex
 
 		void set_abs_fitness(const real _fitness);
 
+		/// Record the fitness of the last evaluation again
+		/// for a network which has not changed since then
+		/// (cf. Config::fit.deterministic). The fitness statistics
+		/// are updated as they would be by a new evaluation,
+		/// but no evaluation is counted.
+		void replay_fitness();
+
 		inline const real get_rel_fitness() const
 		{
 			return fitness.get_rel();
@@ -181,17 +310,6 @@ namespace Cortex
 			return (cfg.net.max.age > 0 && age > cfg.net.max.age);
 		}
 
-		inline void reset_marks()
-		{
-			for (const auto& nrole : nodes)
-			{
-				for (const auto& node : nrole.second)
-				{
-					node.second->mark = Mark::None;
-				}
-			}
-		}
-
 		inline real progress() const
 		{
 			return fitness.progress();
@@ -199,8 +317,10 @@ namespace Cortex
 
 		void connect();
 
-		/// Topological sorting using depth-first search
-		void make_graph(const bool _update = true);
+		/// Compile the evaluation plan from the topological order.
+		/// The order itself is maintained incrementally
+		/// as nodes and links are added (cf. Graph).
+		void make_graph();
 
 		/// Adding a node might result in the creation of a
 		/// new species if no other species has the same genotype.
@@ -224,41 +344,117 @@ namespace Cortex
 		/// cf. Ecosystem::mate()
 		void crossover(Net& _p1, Net& _p2);
 
+		/// Make this network an exact copy of another
+		/// network with the same genotype, including
+		/// its transfer functions and its fitness.
+		/// cf. Ecosystem::select_migrants()
+		void clone(Net& _other);
+
 		void connect(const uint _id);
 
 		void mark_solved();
 
+		/// Indicates that the evaluation should be abandoned
+		/// (e.g., because another network has solved the task).
+		/// Long evaluations should check this periodically.
+		bool is_cancelled() const;
+
 		/////////// Classical nets
 
 		void eval(const std::vector<real>& _input);
 
+		/// Clear the state carried over from earlier evaluations
+		/// by recurrent links, so that the network can be reused
+		/// for a new episode (e.g., a new environment) without
+		/// being rebuilt. Spiking networks start from rest
+		/// in every evaluation anyway.
+		inline void reset_state()
+		{
+			plan.reset_state();
+		}
+
+		/// Evaluate a batch of samples in a single sweep
+		/// of the evaluation graph.
+		/// \param _input Row-major (samples x inputs) matrix.
+		/// \param _samples Number of samples (rows) in the input.
+		/// \param _output Filled with a row-major
+		/// (samples x outputs) matrix.
+		/// For spiking networks with Gaussian receptive fields,
+		/// the encoded batch is shared with the other networks
+		/// evaluated on the same input (cf. GRF::share()).
+		void eval_batch(const std::vector<real>& _input, const uint _samples, std::vector<real>& _output);
+
+		/// Evaluate a batch which has already been
+		/// encoded with Gaussian receptive fields
+		/// (spiking networks only). The latencies
+		/// are only read, so the batch can be shared.
+		void eval_batch(const GRF::Batch& _batch, std::vector<real>& _output);
+
 		inline std::vector<real> get_output() const
 		{
 			std::vector<real> output;
+			get_output(output);
+			return output;
+		}
 
-			for (uint out = 1; out <= nodes.at(NR::O).size(); ++out)
+		/// Write the output into an existing vector.
+		/// No allocation takes place if the vector
+		/// already has the right capacity.
+		inline void get_output(std::vector<real>& _output) const
+		{
+			_output.resize(plan.outputs.size());
+			for (uint out = 0; out < plan.outputs.size(); ++out)
 			{
-				output.emplace_back(nodes.at(NR::O).at(out)->output);
+				_output[out] = plan.output[plan.outputs[out]];
 			}
-
-			return output;
 		}
 
 		////// Spiking nets
 
-		void setup_grf(const std::vector<std::pair<real, real>>& _var_ranges);
-
+		/// Deliver a spike to the target of a link.
+		/// Returns true if the target spikes in turn.
 		bool activate(const event_pair& _e);
 
-		void add_input(const std::vector<real>& _input);
+		/// Record a spike of a node and send it along its outgoing links
+		void fire(const uint _node, const real _time);
+
+		/// Convert a batch of samples into spike latencies
+		/// of the input nodes (cf. latency). Stronger responses
+		/// spike earlier, with latencies up to net.spiking.max.latency.
+		/// Without receptive fields, each input node encodes one
+		/// variable in [0, 1]. With Gaussian receptive fields
+		/// (cf. Config::grf), each sample holds one value per variable.
+		void encode(const std::vector<real>& _input, const uint _samples);
+
+		/// Make sure that the receptive fields match the
+		/// input nodes and that the input covers the batch.
+		void check_grf(const uint _size, const uint _samples) const;
 
 		/// \brief Hebbian learning for links corresponding to
-		/// spikes preceding the postsynaptic spike
-		void stdp_pre_spike();
+		/// spikes preceding the postsynaptic spike.
+		/// Called when _node spikes. Updates the incoming links
+		/// of the node in proportion to the traces of their sources.
+		void stdp_pre_spike(const uint _node, const real _time);
 
 		/// \brief Hebbian learning for links corresponding to
-		/// spikes following the postsynaptic spike
-		void stdp_post_spike();
+		/// spikes following the postsynaptic spike.
+		/// Called when _node spikes. Updates the outgoing links
+		/// of the node in proportion to the traces of their targets.
+		void stdp_post_spike(const uint _node, const real _time);
+
+		/// Trace of a node at a given time
+		inline real stdp_trace(const uint _node, const real _time) const
+		{
+			assert(_time >= traces.time[_node]);
+			return traces.value[_node] * std::exp((traces.time[_node] - _time) / cfg.stdp.span);
+		}
+
+		/// Add a spike to the trace of a node
+		inline void add_trace(const uint _node, const real _time)
+		{
+			traces.value[_node] = stdp_trace(_node, _time) + 1.0;
+			traces.time[_node] = _time;
+		}
 
 		inline json as_json()
 		{
@@ -10,21 +10,26 @@ namespace Cortex
 		  id(_id),
 		  cfg(_net.cfg),
 		  mark(Mark::None),
+		  ord(0),
+		  slot(0),
+		  links(_net.arena),
 		  af(_id.role, _net.cfg),
 		  output(0.0),
 		  tau(_net.cfg, _net.cfg.node.tau)
 	{}
 
-	Node::Node(Node& _other, Net& _net)
+	Node::Node(const NodeID& _id, Node& _other, Net& _net)
 		:
 		  net(_net),
-		  id(_other.id),
+		  id(_id),
 		  cfg(_net.cfg),
 		  mark(Mark::None),
+		  ord(0),
+		  slot(0),
+		  links(_net.arena),
 		  af(_other.id.role, _net.cfg),
 		  output(0.0),
-		  tau(_other.tau),
-		  grf(_other.grf)
+		  tau(_other.tau)
 	{}
 
 	Node::~Node()
@@ -42,7 +47,7 @@ namespace Cortex
 				/// whose weight can be mutated.
 				while (true)
 				{
-					LT lt(cfg.w_dist(cfg.link.type));
+					LT lt(cfg.w_dist(cfg.samplers.link.type));
 					if (!cfg.link.rec ||
 						(!has_targets(LT::R) &&
 						 !has_sources(LT::R)))
@@ -50,7 +55,7 @@ namespace Cortex
 						lt = LT::F;
 					}
 
-					NR other_role(cfg.w_dist(cfg.mutation.node));
+					NR other_role(cfg.w_dist(cfg.samplers.mutation.node));
 
 					if (has_targets(lt, other_role))
 					{
@@ -69,44 +74,14 @@ namespace Cortex
 			return tau.mutate(net.fitness);
 
 		case Mut::Fn:
-			return af.set_fn(cfg.w_dist(cfg.mutation.fn.at(id.role)));
+			return af.set_fn(cfg.w_dist(cfg.samplers.mutation.fn.at(id.role)));
 
 		default:
 			return false;
 		}
 	}
 
-	bool Node::visit(const bool _update_graph)
-	{
-//		dlog() << "Visiting node " << id;
-		switch (mark)
-		{
-		case Mark::Perm: return true;
-		case Mark::Temp: return false; /// Not a DAG
-		case Mark::None:
-			{
-				mark = Mark::Temp;
-				for (auto& nrole : links.targets.at(LT::F))
-				{
-					for (auto& lnk : nrole.second)
-					{
-						if (!lnk.second->tgt.visit(_update_graph))
-						{
-							return false;
-						}
-					}
-				}
-				mark = Mark::Perm;
-				if (_update_graph)
-				{
-					net.graph.emplace_back(*this);
-				}
-				return true;
-			}
-		}
-	}
-
-	void Node::crossover(Node& _p1, Node& _p2, const hmap<uint, real>& _fdist)
+	void Node::crossover(Node& _p1, Node& _p2, const Alignment& _align, const hmap<uint, real>& _fdist)
 	{
 //		dlog d;
 //		d << "Crossing over node " << id << "\n";
@@ -123,8 +98,9 @@ namespace Cortex
 				/// Iterate over indices in parent 1
 				for (auto& idx : _p1.links.targets.at(lt.first).at(nr.first))
 				{
-					/// Temporary node ID
+					/// Temporary node IDs
 					NodeID n_id{nr.first, idx.first};
+					NodeID p2_id{nr.first, _align.fwd.at(nr.first).at(idx.first)};
 
 //					d << "\t\tCrossing over target " << n_id << "\n";
 
@@ -132,13 +108,13 @@ namespace Cortex
 					{
 						bool from_p1(cfg.w_dist(_fdist) == _p1.net.id);
 
-						if (_p2.is_tgt(lt.first, n_id) && !from_p1)
+						if (_p2.is_tgt(lt.first, p2_id) && !from_p1)
 //						if (_p2.is_tgt(lt.first, n_id) && cfg.rnd_chance(0.5))
 						{
 							/// The same link exists in parent 2 as well.
 							/// Copy the link from parent 2
 //							d << "\t\t\tCopying link from network " << _p2.net.id << "\n";
-							add_link(lt.first, net.get_node(n_id), _p2.get_tgt_link(lt.first, n_id));
+							add_link(lt.first, net.get_node(n_id), _p2.get_tgt_link(lt.first, p2_id));
 						}
 						else if (from_p1)
 //						else
@@ -159,7 +135,7 @@ namespace Cortex
 				for (auto& idx : _p2.links.targets.at(lt.first).at(nr.first))
 				{
 					/// Temporary node ID
-					NodeID n_id{nr.first, idx.first};
+					NodeID n_id{nr.first, _align.bwd.at(nr.first).at(idx.first)};
 
 					if (!_p1.is_tgt(lt.first, n_id) &&
 						cfg.w_dist(_fdist) == _p2.net.id &&
@@ -174,6 +150,22 @@ namespace Cortex
 		}
 	}
 
+	void Node::clone(Node& _other)
+	{
+		af.set_fn(_other.af.get_fn());
+
+		for (auto& lt : _other.links.targets)
+		{
+			for (auto& nr : lt.second)
+			{
+				for (auto& idx : nr.second)
+				{
+					add_link(lt.first, net.get_node({nr.first, idx.first}), *idx.second);
+				}
+			}
+		}
+	}
+
 	void Node::connect()
 	{
 		/// Make sure that the node is connected
@@ -194,7 +186,7 @@ namespace Cortex
 				/// Pick a random target role
 				do
 				{
-					tgt_id.role = cfg.w_dist(cfg.link.prob.at(LT::F).at(id.role));
+					tgt_id.role = cfg.w_dist(cfg.samplers.link.tgt.at(id.role));
 				} while (net.node_count(tgt_id.role) == 0);
 
 				/// Pick a random node in that role
@@ -210,17 +202,7 @@ namespace Cortex
 			 id.role == NR::O) &&
 			!has_sources(LT::F))
 		{
-			emap<NR, real> src_roles;
-			for (const auto& srole : cfg.link.prob.at(LT::F))
-			{
-				for (const auto& trole : srole.second)
-				{
-					if (trole.first == id.role)
-					{
-						src_roles.emplace(srole.first, trole.second);
-					}
-				}
-			}
+			const auto& src_roles(cfg.samplers.link.src.at(id.role));
 
 			/// Pick a random source
 			NodeID src_id;
@@ -278,10 +260,52 @@ namespace Cortex
 
 	bool Node::forms_cycle(Node& _tgt)
 	{
-		net.reset_marks();
-		add_link(LT::F, _tgt);
-		bool is_dag(visit(false));
-		erase_link(LT::F, _tgt.id);
-		return !is_dag;
+		/// The link closes a cycle if
+		/// this node is reachable from the target.
+		return net.graph.reaches(_tgt, *this);
+	}
+
+	void Node::add_link(const LT _lt, Node& _tgt)
+	{
+		//		dlog d;
+		//		d << "*** Adding " << _lt << " link " << id << "->" << _tgt.id << "...";
+		links.add(_lt, *this, _tgt, cfg);
+		//		d << "success!";
+		update_order(_lt, _tgt);
+	}
+
+	void Node::add_link(const LT _lt, Node& _tgt, Link& _other)
+	{
+		//		dlog d;
+		//		d << "*** Copying " << _lt << " link " << id << "->" << _tgt.id << "...";
+		links.add(_lt, *this, _tgt, _other);
+		//		d << "success!";
+		update_order(_lt, _tgt);
+	}
+
+	void Node::erase_link(const LT _lt, const NodeID& _id)
+	{
+		//		dlog d;
+		//		d << "*** Erasing " << _lt << " link " << id << "->" << _id << "...";
+		links.erase(_lt, _id);
+		//		d << "success!";
+
+		/// Paths through the link are gone
+		if (_lt == LT::F)
+		{
+			net.graph.erase_link(*this);
+		}
+	}
+
+	void Node::update_order(const LT _lt, Node& _tgt)
+	{
+		/// Recurrent links do not constrain the order
+		if (_lt == LT::F &&
+			!net.graph.add_link(*this, _tgt))
+		{
+			dlog() << "Node::add_link(): Link " << id << " -> " << _tgt.id
+				   << " forms a cycle in network " << net.id;
+			exit(EXIT_FAILURE);
+		}
 	}
 }
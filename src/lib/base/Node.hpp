@@ -3,10 +3,13 @@
 
 #include "Link.hpp"
 #include "Activation.hpp"
-#include "GRF.hpp"
 
 namespace Cortex
 {
+	/// Node identifier.
+	/// The index is a handle issued by NodeHandles
+	/// which does not change during the lifetime
+	/// of the node, even if other nodes are erased.
 	struct NodeID
 	{
 		NR role;
@@ -23,6 +26,61 @@ namespace Cortex
 		}
 	};
 
+	/// \brief Generational handles for the nodes
+	/// of one role in a network.
+	///
+	/// A handle packs a slot number (lower 16 bits, starting at 1)
+	/// and the generation of the slot (upper 16 bits).
+	/// Erasing a node releases the slot for reuse and bumps its
+	/// generation, so a stale handle never matches a newer node.
+	struct NodeHandles
+	{
+		static constexpr uint slot_bits = 16;
+		static constexpr uint slot_mask = (1u << slot_bits) - 1;
+
+		/// Current generation of each slot (slot - 1)
+		std::vector<uint> gen;
+
+		/// Released slots
+		std::vector<uint> free;
+
+		inline uint acquire()
+		{
+			uint slot(0);
+			if (free.empty())
+			{
+				gen.push_back(0);
+				slot = gen.size();
+			}
+			else
+			{
+				slot = free.back();
+				free.pop_back();
+			}
+			return (gen[slot - 1] << slot_bits) | slot;
+		}
+
+		inline void release(const uint _handle)
+		{
+			const uint slot(_handle & slot_mask);
+			gen[slot - 1] = (gen[slot - 1] + 1) & slot_mask;
+			free.push_back(slot);
+		}
+	};
+
+	/// Correspondence between the nodes of two networks
+	/// with the same genotype (cf. Net::crossover()).
+	/// Nodes are matched by their position among the
+	/// nodes with the same role, taken in handle order.
+	struct Alignment
+	{
+		/// Handles in the first network -> handles in the second
+		emap<NR, hmap<uint, uint>> fwd;
+
+		/// Handles in the second network -> handles in the first
+		emap<NR, hmap<uint, uint>> bwd;
+	};
+
 	class Node
 	{
 	public:
@@ -33,9 +91,15 @@ namespace Cortex
 
 		real output;
 
-		/// Helper enum class for topological sorting
+		/// Helper enum class for graph searches
 		Mark mark;
 
+		/// Position in the topological order (cf. Graph)
+		uint ord;
+
+		/// Row in the reachability matrix (cf. Graph)
+		uint slot;
+
 	private:
 
 		Net& net;
@@ -46,12 +110,6 @@ namespace Cortex
 
 		Param tau;
 
-		std::vector<real> input;
-
-		/// Gaussian receptive field
-		/// \todo: Generic receptive field class.
-		GRF grf;
-
 		/// The current activation level
 		real al;
 
@@ -69,6 +127,8 @@ namespace Cortex
 		friend std::ostream& operator<< (std::ostream&, const Net&);
 		friend class Link;
 		friend class Links;
+		friend struct Plan;
+		friend struct Graph;
 
 	public:
 
@@ -80,7 +140,8 @@ namespace Cortex
 
 		explicit Node(const NodeID& _id, Net& _net);
 
-		explicit Node(Node& _other, Net& _net);
+		/// Copy the parameters of a node in another network
+		explicit Node(const NodeID& _id, Node& _other, Net& _net);
 
 		~Node();
 
@@ -97,15 +158,17 @@ namespace Cortex
 			return link_count(LT::F) + link_count(LT::R);
 		}
 
-		/// Classical network
-		inline void eval()
+		/// Spiking network.
+		/// Returns true if the input makes the node spike.
+		/// Inputs arriving at the time of a spike are ignored,
+		/// so a node spikes at most once at any given time.
+		inline bool eval(const real& _cur_time, const real& _input)
 		{
-			output = af.eval(input);
-		}
+			if (_cur_time == last_spike)
+			{
+				return false;
+			}
 
-		/// Spiking network
-		inline void eval(const real& _cur_time, const real& _input)
-		{
 			/// Compute the current activation level
 			/// based on the last evaluation time.
 			if (cfg.node.lif)
@@ -120,26 +183,19 @@ namespace Cortex
 			{
 				al = 0.0;
 				last_spike = _cur_time;
+				return true;
 			}
-		}
-
-		inline void add_input(const real _val)
-		{
-			input.push_back(_val);
-		}
 
-		inline void set_grf(const uint _N,
-							const uint _i,
-							const real _beta,
-							const real _i_min,
-							const real _i_max)
-		{
-			grf = GRF(_N, _i, _beta, _i_min, _i_max);
+			return false;
 		}
 
-		inline real get_grf_delay(const real _input)
+		/// Return to the resting state
+		/// before a new spiking evaluation.
+		inline void reset()
 		{
-			return grf.get_delay(_input);
+			al = 0.0;
+			last_input = 0.0;
+			last_spike = -1.0;
 		}
 
 		bool mutate(const Mut _mut);
@@ -160,53 +216,17 @@ namespace Cortex
 			last_spike = _t;
 		}
 
-		inline void propagate()
-		{
-			/// First get all input from recurrent links
-			if (cfg.link.rec)
-			{
-				get_rec();
-			}
-
-			/// Evaluate the node
-			eval();
-
-			/// Propagate the output
-			if (output != 0.0)
-			{
-				for (auto& role : links.targets.at(LT::F))
-				{
-					for (auto& link : role.second)
-					{
-						link.second->tgt.add_input(output * link.second->weight.val());
-					}
-				}
-			}
-
-			/// Clear the input vector in preparation
-			/// for the next evaluation
-			input.clear();
-		}
-
-		inline void get_rec()
-		{
-			for (auto& role : links.sources.at(LT::R))
-			{
-				for (auto& link : role.second)
-				{
-					if (link.second.get().src.output != 0.0)
-					{
-						add_input(link.second.get().src.output * link.second.get().weight.val());
-					}
-				}
-			}
-		}
-
-		bool visit(const bool _update_graph);
-
 		void connect();
 
-		void crossover(Node& _n1, Node& _n2, const hmap<uint, real>& _fdist);
+		/// Inherit links from the corresponding nodes
+		/// in two parents. The handles of this network
+		/// are the same as those of _p1.
+		void crossover(Node& _p1, Node& _p2, const Alignment& _align, const hmap<uint, real>& _fdist);
+
+		/// Copy the transfer function and the outgoing
+		/// links of the corresponding node in an identical
+		/// network (cf. Net::clone()).
+		void clone(Node& _other);
 
 		inline bool has_targets(const LT _lt) const
 		{
@@ -313,6 +333,8 @@ namespace Cortex
 			}
 		}
 
+		/// Check if a forward link to _tgt
+		/// would close a cycle.
 		bool forms_cycle(Node& _tgt);
 
 		inline Link& get_tgt_link(const LT _lt, const NodeID& _id)
@@ -325,34 +347,11 @@ namespace Cortex
 			return links.sources.at(_lt).at(_id.role).at(_id.idx).get();
 		}
 
-		inline void add_link(const LT _lt, Node& _tgt)
-		{
-			//		dlog d;
-			//		d << "*** Adding " << _lt << " link " << id << "->" << _tgt.id << "...";
-			links.add(_lt, *this, _tgt, cfg);
-			//		d << "success!";
-		}
+		void add_link(const LT _lt, Node& _tgt);
 
-		inline void add_link(const LT _lt, Node& _tgt, Link& _other)
-		{
-			//		dlog d;
-			//		d << "*** Copying " << _lt << " link " << id << "->" << _tgt.id << "...";
-			links.add(_lt, *this, _tgt, _other);
-			//		d << "success!";
-		}
+		void add_link(const LT _lt, Node& _tgt, Link& _other);
 
-		inline void erase_link(const LT _lt, const NodeID& _id)
-		{
-			//		dlog d;
-			//		d << "*** Erasing " << _lt << " link " << id << "->" << _id << "...";
-			links.erase(_lt, _id);
-			//		d << "success!";
-		}
-
-		inline void reindex(const NodeID& _id)
-		{
-			links.reindex(_id);
-		}
+		void erase_link(const LT _lt, const NodeID& _id);
 
 		void disconnect();
 
@@ -364,7 +363,9 @@ namespace Cortex
 
 	private:
 
-
+		/// Keep the topological order of
+		/// the network valid after adding a link.
+		void update_order(const LT _lt, Node& _tgt);
 	};
 }
 
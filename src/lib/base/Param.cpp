@@ -20,6 +20,7 @@ namespace Cortex
 		:
 		  cfg(_cfg),
 		  stats(_stats),
+		  act(Act::Undef),
 		  importance(0.0)
 	{
 		stats.val = cfg.rnd_nd(stats.mean, stats.sd);
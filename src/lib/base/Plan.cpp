@@ -0,0 +1,1049 @@
+#include "Plan.hpp"
+#include "Node.hpp"
+#include "Kernels.hpp"
+
+namespace Cortex
+{
+	constexpr uint Plan::none;
+
+	/// Transfer functions which operate
+	/// on the sum of the inputs.
+	static inline real apply(const Fn _fn, const real _x)
+	{
+		switch (_fn)
+		{
+		case Fn::Sum:
+			return _x;
+
+		case Fn::Tanh:
+			return Tanh(_x);
+
+		case Fn::Logistic:
+			return Sigmoid(_x);
+
+		case Fn::ReLU:
+			return ReLU(_x);
+
+		case Fn::Gaussian:
+			return Gaussian(_x);
+
+		case Fn::Sin:
+			return Sin(_x);
+
+		case Fn::Cos:
+			return Cos(_x);
+
+		case Fn::Abs:
+			return Abs(_x);
+
+		case Fn::Const:
+			return 1.0;
+
+		case Fn::Golden:
+			return phi;
+
+		default:
+			return 0.0;
+		}
+	}
+
+	/// Transfer functions which compute order
+	/// statistics over the individual inputs
+	static inline bool order_stat(const Fn _fn)
+	{
+		return (_fn == Fn::Min ||
+				_fn == Fn::Max ||
+				_fn == Fn::Avg);
+	}
+
+	/// Transfer functions whose output ignores the input
+	static inline bool fixed(const Fn _fn)
+	{
+		return (_fn == Fn::Const ||
+				_fn == Fn::Golden);
+	}
+
+	/// Inputs to nodes with a fixed output are ignored.
+	/// Order statistics count zero-weight inputs.
+	static inline bool link_alive(const Fn _tgt, const real _weight)
+	{
+		return (!fixed(_tgt) &&
+				(_weight != 0.0 || order_stat(_tgt)));
+	}
+
+	/// Running order statistics over the inputs of a node.
+	/// Only inputs from active sources are considered.
+	struct OrderStat
+	{
+		real min = 0.0;
+		real max = 0.0;
+		real avg = 0.0;
+		uint count = 0;
+
+		inline void add(const real _val)
+		{
+			if (count == 0 || _val < min)
+			{
+				min = _val;
+			}
+			if (count == 0 || _val > max)
+			{
+				max = _val;
+			}
+			avg += (_val + avg) / (count + 1);
+			++count;
+		}
+
+		inline real get(const Fn _fn) const
+		{
+			switch (_fn)
+			{
+			case Fn::Min:
+				return min;
+
+			case Fn::Max:
+				return max;
+
+			default:
+				return avg;
+			}
+		}
+	};
+
+	void Plan::compile(const std::vector<NodeRef>& _graph, const bool _rec)
+	{
+		clear();
+
+		/// Position of each node in the topological order
+		emap<NR, hmap<uint, uint>> pos;
+		for (uint i = 0; i < _graph.size(); ++i)
+		{
+			const Node& node(_graph[i].get());
+			pos[node.id.role].emplace(node.id.idx, i);
+			nodes.emplace_back(_graph[i]);
+		}
+
+		fn.reserve(_graph.size());
+		ext.reserve(_graph.size());
+		all.fwd.offset.reserve(_graph.size() + 1);
+		all.rec.offset.reserve(_graph.size() + 1);
+
+		all.fwd.offset.push_back(0);
+		all.rec.offset.push_back(0);
+
+		std::vector<std::pair<uint, ParamRef>> sources;
+		std::vector<std::pair<uint, uint>> in_ids;
+		std::vector<std::pair<uint, uint>> out_ids;
+
+		for (uint i = 0; i < _graph.size(); ++i)
+		{
+			Node& node(_graph[i].get());
+
+			fn.push_back(node.af.get_fn());
+			ext.push_back(none);
+
+			if (node.id.role == NR::I)
+			{
+				in_ids.emplace_back(node.id.idx, i);
+			}
+			else if (node.id.role == NR::O)
+			{
+				out_ids.emplace_back(node.id.idx, i);
+			}
+
+			/// Forward sources are sorted by their position
+			/// in the plan so that the inputs of each node
+			/// are accumulated in evaluation order.
+			sources.clear();
+			for (auto& nrole : node.links.sources.at(LT::F))
+			{
+				for (auto& lnk : nrole.second)
+				{
+					sources.emplace_back(pos.at(nrole.first).at(lnk.first), lnk.second.get().weight);
+				}
+			}
+
+			std::sort(sources.begin(), sources.end(), [](const auto& _l, const auto& _r)
+			{
+				return _l.first < _r.first;
+			});
+
+			for (const auto& s : sources)
+			{
+				all.fwd.src.push_back(s.first);
+				all.fwd.weight.push_back(s.second.get().val());
+				fwd_params.push_back(s.second);
+			}
+			all.fwd.offset.push_back(all.fwd.src.size());
+
+			if (_rec)
+			{
+				for (auto& nrole : node.links.sources.at(LT::R))
+				{
+					for (auto& lnk : nrole.second)
+					{
+						all.rec.src.push_back(pos.at(nrole.first).at(lnk.first));
+						all.rec.weight.push_back(lnk.second.get().weight.val());
+						rec_params.push_back(lnk.second.get().weight);
+					}
+				}
+			}
+			all.rec.offset.push_back(all.rec.src.size());
+		}
+
+		/// Inputs and outputs are ordered by node handle
+		std::sort(in_ids.begin(), in_ids.end());
+		for (uint in = 0; in < in_ids.size(); ++in)
+		{
+			ext[in_ids[in].second] = in;
+		}
+		in_count = in_ids.size();
+
+		std::sort(out_ids.begin(), out_ids.end());
+		for (const auto& o : out_ids)
+		{
+			outputs.push_back(o.second);
+		}
+
+		output.assign(_graph.size(), 0.0);
+		cache.stale.assign(_graph.size(), 0);
+		scratch.pending.assign(_graph.size(), 0);
+
+		route();
+		prune();
+	}
+
+	void Plan::sync()
+	{
+		bool prune_all(false);
+		for (uint i = 0; i < nodes.size(); ++i)
+		{
+			prune_all |= reload(i);
+		}
+
+		if (prune_all)
+		{
+			prune();
+		}
+	}
+
+	void Plan::sync(const Node& _node)
+	{
+		/// The position of a node in the plan is its
+		/// position in the topological order (cf. Graph).
+		bool prune_all(reload(_node.ord));
+		for (const auto& lt : _node.links.targets)
+		{
+			for (const auto& nr : lt.second)
+			{
+				for (const auto& lnk : nr.second)
+				{
+					prune_all |= reload(lnk.second->tgt.ord);
+				}
+			}
+		}
+
+		if (prune_all)
+		{
+			prune();
+		}
+	}
+
+	bool Plan::reload(const uint _i)
+	{
+		/// Changes which make links or nodes live
+		/// or dead require the plan to be pruned again.
+		bool prune_all(false);
+		bool changed(false);
+
+		const Fn f(nodes[_i].get().af.get_fn());
+		if (f != fn[_i])
+		{
+			prune_all = (needed[_i] &&
+						 (fixed(f) != fixed(fn[_i]) ||
+						  order_stat(f) != order_stat(fn[_i]) ||
+						  (f == Fn::Sum) != (fn[_i] == Fn::Sum)));
+			fn[_i] = f;
+			cache.stale[_i] = 1;
+			changed = true;
+		}
+
+		/// Forward links are stored by target node
+		for (uint l = all.fwd.offset[_i]; l < all.fwd.offset[_i + 1]; ++l)
+		{
+			const real w(fwd_params[l].get().val());
+			if (w != all.fwd.weight[l])
+			{
+				prune_all |= (needed[_i] &&
+							  link_alive(fn[_i], w) != link_alive(fn[_i], all.fwd.weight[l]));
+				all.fwd.weight[l] = w;
+				changed = true;
+			}
+		}
+
+		for (uint l = all.rec.offset[_i]; l < all.rec.offset[_i + 1]; ++l)
+		{
+			const real w(rec_params[l].get().val());
+			if (w != all.rec.weight[l])
+			{
+				prune_all |= (needed[_i] &&
+							  link_alive(fn[_i], w) != link_alive(fn[_i], all.rec.weight[l]));
+				all.rec.weight[l] = w;
+				changed = true;
+			}
+		}
+
+		if (!changed ||
+			!needed[_i] ||
+			prune_all)
+		{
+			return prune_all;
+		}
+
+		/// Constant subgraphs and Sum chains which
+		/// depend on the node are recomputed as well.
+		if (folded[_i] ||
+			via[_i] != none)
+		{
+			recompose(_i);
+			return false;
+		}
+
+		if (!alive[_i])
+		{
+			return true;
+		}
+
+		/// Only this node has to be recomputed. The nodes
+		/// downstream of it are recomputed by eval_batch()
+		/// if its activations change.
+		relink(_i);
+		cache.stale[_i] = 1;
+		return false;
+	}
+
+	void Plan::relink(const uint _i)
+	{
+		/// Same as the rebuild in prune(),
+		/// but writing the weights in place.
+		bias[_i] = 0.0;
+
+		uint pos(fwd.offset[_i]);
+		for (uint l = all.fwd.offset[_i]; l < all.fwd.offset[_i + 1]; ++l)
+		{
+			const uint src(all.fwd.src[l]);
+			const real w(all.fwd.weight[l]);
+
+			if (!link_alive(fn[_i], w))
+			{
+				continue;
+			}
+
+			if (!order_stat(fn[_i]))
+			{
+				if (folded[src])
+				{
+					bias[_i] += value[src] * w;
+					continue;
+				}
+
+				if (via[src] != none)
+				{
+					bias[_i] += shift[src] * w;
+					fwd.weight[pos++] = scale[src] * w;
+					continue;
+				}
+			}
+
+			fwd.weight[pos++] = w;
+		}
+
+		pos = rec.offset[_i];
+		for (uint l = all.rec.offset[_i]; l < all.rec.offset[_i + 1]; ++l)
+		{
+			if (link_alive(fn[_i], all.rec.weight[l]))
+			{
+				rec.weight[pos++] = all.rec.weight[l];
+			}
+		}
+	}
+
+	real Plan::fold(const uint _i) const
+	{
+		if (fixed(fn[_i]))
+		{
+			return apply(fn[_i], 0.0);
+		}
+
+		/// Evaluate the node once
+		OrderStat os;
+		real x(0.0);
+		for (uint l = all.fwd.offset[_i]; l < all.fwd.offset[_i + 1]; ++l)
+		{
+			if (link_alive(fn[_i], all.fwd.weight[l]))
+			{
+				const real v(value[all.fwd.src[l]]);
+				x += v * all.fwd.weight[l];
+				if (v != 0.0)
+				{
+					os.add(v * all.fwd.weight[l]);
+				}
+			}
+		}
+
+		return (order_stat(fn[_i]) ? os.get(fn[_i]) : apply(fn[_i], x));
+	}
+
+	void Plan::compose(const uint _i)
+	{
+		uint src(none);
+		real w(0.0);
+		real b(0.0);
+		uint vars(0);
+		for (uint l = all.fwd.offset[_i]; l < all.fwd.offset[_i + 1]; ++l)
+		{
+			if (!link_alive(fn[_i], all.fwd.weight[l]))
+			{
+				continue;
+			}
+
+			if (folded[all.fwd.src[l]])
+			{
+				b += value[all.fwd.src[l]] * all.fwd.weight[l];
+			}
+			else
+			{
+				src = all.fwd.src[l];
+				w = all.fwd.weight[l];
+				++vars;
+			}
+		}
+
+		if (vars != 1)
+		{
+			return;
+		}
+
+		if (via[src] == none)
+		{
+			via[_i] = src;
+			scale[_i] = w;
+			shift[_i] = b;
+		}
+		else
+		{
+			via[_i] = via[src];
+			scale[_i] = scale[src] * w;
+			shift[_i] = shift[src] * w + b;
+		}
+	}
+
+	void Plan::recompose(const uint _i)
+	{
+		/// Nodes are visited in topological order, and
+		/// forward links always point further down the order,
+		/// so each affected node is recomputed once after
+		/// all of its sources.
+		std::vector<char>& pending(scratch.pending);
+		pending[_i] = 1;
+		uint last(_i);
+
+		for (uint i = _i; i <= last; ++i)
+		{
+			if (!pending[i])
+			{
+				continue;
+			}
+			pending[i] = 0;
+
+			bool propagate(false);
+			if (folded[i])
+			{
+				const real v(fold(i));
+				propagate = (v != value[i]);
+				value[i] = v;
+			}
+			else
+			{
+				if (via[i] != none)
+				{
+					const real a(scale[i]);
+					const real b(shift[i]);
+					compose(i);
+					propagate = (a != scale[i] || b != shift[i]);
+				}
+
+				if (alive[i])
+				{
+					relink(i);
+				}
+			}
+			cache.stale[i] = 1;
+
+			if (!propagate)
+			{
+				continue;
+			}
+
+			/// Recurrent links read the output at run time
+			for (uint l = out.offset[i]; l < out.offset[i + 1]; ++l)
+			{
+				const uint tgt(out.tgt[l]);
+				if (out.link[l] < all.fwd.src.size() &&
+					needed[tgt])
+				{
+					pending[tgt] = 1;
+					last = std::max(last, tgt);
+				}
+			}
+		}
+	}
+
+	void Plan::route()
+	{
+		const uint count(fn.size());
+		const uint fwd_count(all.fwd.src.size());
+
+		/// Count the outgoing links of each node
+		out.clear();
+		out.offset.assign(count + 1, 0);
+		for (const uint src : all.fwd.src)
+		{
+			++out.offset[src + 1];
+		}
+		for (const uint src : all.rec.src)
+		{
+			++out.offset[src + 1];
+		}
+		std::partial_sum(out.offset.begin(), out.offset.end(), out.offset.begin());
+
+		out.tgt.resize(out.offset.back());
+		out.link.resize(out.offset.back());
+
+		/// Targets are visited in plan order, so the
+		/// outgoing links of each node are sorted by target.
+		std::vector<uint> next(out.offset.begin(), out.offset.end() - 1);
+		for (uint i = 0; i < count; ++i)
+		{
+			for (uint l = all.fwd.offset[i]; l < all.fwd.offset[i + 1]; ++l)
+			{
+				const uint pos(next[all.fwd.src[l]]++);
+				out.tgt[pos] = i;
+				out.link[pos] = l;
+			}
+
+			for (uint l = all.rec.offset[i]; l < all.rec.offset[i + 1]; ++l)
+			{
+				const uint pos(next[all.rec.src[l]]++);
+				out.tgt[pos] = i;
+				out.link[pos] = fwd_count + l;
+			}
+		}
+	}
+
+	void Plan::prune()
+	{
+		const uint count(fn.size());
+
+		auto live_link([&](const uint _tgt, const real _weight)
+		{
+			return link_alive(fn[_tgt], _weight);
+		});
+
+		/// Walk backwards from the outputs.
+		/// Recurrent links can point forward in the order,
+		/// so a work list is used instead of a single sweep.
+		std::vector<uint>& work(scratch.work);
+		auto walk([&](const Links& _fwd, const Links& _rec, auto&& _link_alive)
+		{
+			alive.assign(count, 0);
+			for (const uint o : outputs)
+			{
+				if (!alive[o])
+				{
+					alive[o] = 1;
+					work.push_back(o);
+				}
+			}
+
+			while (!work.empty())
+			{
+				const uint i(work.back());
+				work.pop_back();
+
+				for (const Links* links : {&_fwd, &_rec})
+				{
+					for (uint l = links->offset[i]; l < links->offset[i + 1]; ++l)
+					{
+						const uint src(links->src[l]);
+						if (!alive[src] &&
+							_link_alive(i, links->weight[l]))
+						{
+							alive[src] = 1;
+							work.push_back(src);
+						}
+					}
+				}
+			}
+		});
+
+		/// The previous plan, for finding the nodes
+		/// whose cached activations are out of date
+		const bool update(alive.size() == count);
+		std::swap(scratch.alive, alive);
+		std::swap(scratch.folded, folded);
+		std::swap(scratch.value, value);
+		std::swap(scratch.bias, bias);
+		std::swap(scratch.fwd, fwd);
+
+		const std::vector<char>& was_alive(scratch.alive);
+		const std::vector<char>& was_folded(scratch.folded);
+		const std::vector<real>& old_value(scratch.value);
+		const std::vector<real>& old_bias(scratch.bias);
+		const Links& old_fwd(scratch.fwd);
+
+		walk(all.fwd, all.rec, live_link);
+		needed.assign(alive.begin(), alive.end());
+
+		auto has_rec([&](const uint _i)
+		{
+			for (uint l = all.rec.offset[_i]; l < all.rec.offset[_i + 1]; ++l)
+			{
+				if (live_link(_i, all.rec.weight[l]))
+				{
+					return true;
+				}
+			}
+			return false;
+		});
+
+		/// Constant folding.
+		/// Nodes are visited in topological order, so the
+		/// sources of a node have been visited before the node.
+		/// Nodes with recurrent inputs are not folded because
+		/// those inputs are 0 in the first step.
+		folded.assign(count, 0);
+		value.assign(count, 0.0);
+		for (uint i = 0; i < count; ++i)
+		{
+			if (!alive[i])
+			{
+				continue;
+			}
+
+			if (fixed(fn[i]))
+			{
+				folded[i] = 1;
+				value[i] = fold(i);
+				continue;
+			}
+
+			if (ext[i] != none ||
+				has_rec(i))
+			{
+				continue;
+			}
+
+			bool constant(true);
+			for (uint l = all.fwd.offset[i]; l < all.fwd.offset[i + 1] && constant; ++l)
+			{
+				constant = (!live_link(i, all.fwd.weight[l]) || folded[all.fwd.src[l]]);
+			}
+
+			if (constant)
+			{
+				folded[i] = 1;
+				value[i] = fold(i);
+			}
+		}
+
+		/// Sum chains.
+		/// The output of a Sum node with a single variable input
+		/// is an affine function of that input (scale * input + shift),
+		/// so the nodes which it feeds can link to the input directly.
+		/// Chains are resolved in a single pass in topological order.
+		via.assign(count, none);
+		scale.assign(count, 1.0);
+		shift.assign(count, 0.0);
+		for (uint i = 0; i < count; ++i)
+		{
+			if (alive[i] &&
+				!folded[i] &&
+				fn[i] == Fn::Sum &&
+				ext[i] == none &&
+				!has_rec(i))
+			{
+				compose(i);
+			}
+		}
+
+		/// Rebuild the links used for evaluation.
+		/// Order statistics need their inputs one by one,
+		/// so their links are kept as they are.
+		bias.assign(count, 0.0);
+		fwd.clear();
+		fwd.offset.push_back(0);
+		for (uint i = 0; i < count; ++i)
+		{
+			if (alive[i] &&
+				!folded[i])
+			{
+				for (uint l = all.fwd.offset[i]; l < all.fwd.offset[i + 1]; ++l)
+				{
+					const uint src(all.fwd.src[l]);
+					const real w(all.fwd.weight[l]);
+
+					if (!live_link(i, w))
+					{
+						continue;
+					}
+
+					if (!order_stat(fn[i]))
+					{
+						if (folded[src])
+						{
+							bias[i] += value[src] * w;
+							continue;
+						}
+
+						if (via[src] != none)
+						{
+							bias[i] += shift[src] * w;
+							fwd.src.push_back(via[src]);
+							fwd.weight.push_back(scale[src] * w);
+							continue;
+						}
+					}
+
+					fwd.src.push_back(src);
+					fwd.weight.push_back(w);
+				}
+			}
+			fwd.offset.push_back(fwd.src.size());
+		}
+
+		rec.clear();
+		rec.offset.push_back(0);
+		for (uint i = 0; i < count; ++i)
+		{
+			if (alive[i] &&
+				!folded[i])
+			{
+				for (uint l = all.rec.offset[i]; l < all.rec.offset[i + 1]; ++l)
+				{
+					if (live_link(i, all.rec.weight[l]))
+					{
+						rec.src.push_back(all.rec.src[l]);
+						rec.weight.push_back(all.rec.weight[l]);
+					}
+				}
+			}
+			rec.offset.push_back(rec.src.size());
+		}
+
+		/// Nodes which were bypassed or only fed
+		/// folded nodes are no longer needed.
+		walk(fwd, rec, [](const uint, const real) { return true; });
+
+		live.clear();
+		for (uint i = 0; i < count; ++i)
+		{
+			if (!alive[i])
+			{
+				output[i] = 0.0;
+				continue;
+			}
+
+			live.push_back(i);
+
+			/// Mark the nodes whose cached activations are out of date
+			if (update &&
+				!cache.stale[i])
+			{
+				bool same(was_alive[i] &&
+						  was_folded[i] == folded[i]);
+
+				if (same && folded[i])
+				{
+					same = (old_value[i] == value[i]);
+				}
+				else if (same)
+				{
+					same = (old_bias[i] == bias[i] &&
+							old_fwd.offset[i + 1] - old_fwd.offset[i] == fwd.offset[i + 1] - fwd.offset[i] &&
+							std::equal(fwd.src.begin() + fwd.offset[i], fwd.src.begin() + fwd.offset[i + 1], old_fwd.src.begin() + old_fwd.offset[i]) &&
+							std::equal(fwd.weight.begin() + fwd.offset[i], fwd.weight.begin() + fwd.offset[i + 1], old_fwd.weight.begin() + old_fwd.offset[i]));
+				}
+
+				cache.stale[i] = !same;
+			}
+		}
+
+		/// Recurrent links read the current outputs in the next step
+		state = output;
+		recur.assign(count, 0.0);
+	}
+
+	void Plan::eval(const std::vector<real>& _input)
+	{
+		if (_input.size() < in_count)
+		{
+			dlog() << "Plan::eval(): Input size " << _input.size()
+				   << " is less than the number of inputs (" << in_count << ")";
+			exit(EXIT_FAILURE);
+		}
+
+		step(_input.data());
+	}
+
+	void Plan::step(const real* _input)
+	{
+		if (!rec.src.empty())
+		{
+			/// The outputs of the last step become the state.
+			/// Live and folded nodes are all rewritten below,
+			/// and the other nodes are 0 in both buffers.
+			output.swap(state);
+
+			for (const uint i : live)
+			{
+				real x(0.0);
+				for (uint l = rec.offset[i]; l < rec.offset[i + 1]; ++l)
+				{
+					x += state[rec.src[l]] * rec.weight[l];
+				}
+				recur[i] = x;
+			}
+		}
+
+		for (const uint i : live)
+		{
+			if (folded[i])
+			{
+				output[i] = value[i];
+				continue;
+			}
+
+			switch (fn[i])
+			{
+			case Fn::Min:
+			case Fn::Max:
+			case Fn::Avg:
+				{
+					OrderStat os;
+
+					if (ext[i] != none)
+					{
+						os.add(_input[ext[i]]);
+					}
+
+					for (uint l = fwd.offset[i]; l < fwd.offset[i + 1]; ++l)
+					{
+						if (output[fwd.src[l]] != 0.0)
+						{
+							os.add(output[fwd.src[l]] * fwd.weight[l]);
+						}
+					}
+
+					for (uint l = rec.offset[i]; l < rec.offset[i + 1]; ++l)
+					{
+						if (state[rec.src[l]] != 0.0)
+						{
+							os.add(state[rec.src[l]] * rec.weight[l]);
+						}
+					}
+
+					output[i] = os.get(fn[i]);
+					break;
+				}
+
+			default:
+				{
+					real x((ext[i] != none ? _input[ext[i]] : 0.0) + bias[i]);
+
+					for (uint l = fwd.offset[i]; l < fwd.offset[i + 1]; ++l)
+					{
+						x += output[fwd.src[l]] * fwd.weight[l];
+					}
+
+					if (rec.offset[i + 1] > rec.offset[i])
+					{
+						x += recur[i];
+					}
+
+					output[i] = apply(fn[i], x);
+				}
+			}
+		}
+	}
+
+	void Plan::eval_batch(const std::vector<real>& _input, const uint _samples, std::vector<real>& _output)
+	{
+		if (_input.size() != _samples * in_count)
+		{
+			dlog() << "Plan::eval_batch(): Input size " << _input.size()
+				   << " does not match " << _samples << " samples x " << in_count << " inputs";
+			exit(EXIT_FAILURE);
+		}
+
+		const uint out_count(outputs.size());
+		_output.resize(_samples * out_count);
+
+		if (_samples == 0)
+		{
+			return;
+		}
+
+		if (!rec.src.empty())
+		{
+			/// Recurrent links carry state from one sample
+			/// to the next, so the samples have to be
+			/// evaluated in sequence.
+			for (uint s = 0; s < _samples; ++s)
+			{
+				step(&_input[s * in_count]);
+				for (uint o = 0; o < out_count; ++o)
+				{
+					_output[s * out_count + o] = output[outputs[o]];
+				}
+			}
+			return;
+		}
+
+		/// Node-major activation matrix.
+		/// Row i holds the output of node i for all samples.
+		const bool reuse(delta &&
+						 cache.valid &&
+						 batch.size() == fn.size() * _samples &&
+						 cache.input == _input);
+
+		if (reuse)
+		{
+			/// Recompute the nodes whose parameters have changed
+			/// and those with an input whose activations have changed.
+			/// Nodes are visited in topological order, so the
+			/// changes propagate in a single sweep.
+			cache.changed.assign(fn.size(), 0);
+			for (const uint i : live)
+			{
+				bool recompute(cache.stale[i] != 0);
+				for (uint l = fwd.offset[i]; l < fwd.offset[i + 1] && !recompute; ++l)
+				{
+					recompute = (cache.changed[fwd.src[l]] != 0);
+				}
+
+				if (!recompute)
+				{
+					continue;
+				}
+
+				const real* x(&batch[i * _samples]);
+				cache.prev.assign(x, x + _samples);
+				eval_row(i, _input, _samples);
+				cache.changed[i] = !std::equal(x, x + _samples, cache.prev.begin());
+			}
+		}
+		else
+		{
+			batch.resize(fn.size() * _samples);
+
+			for (const uint i : live)
+			{
+				eval_row(i, _input, _samples);
+			}
+
+			if (delta)
+			{
+				cache.input = _input;
+				cache.valid = true;
+			}
+		}
+
+		std::fill(cache.stale.begin(), cache.stale.end(), 0);
+
+		for (uint s = 0; s < _samples; ++s)
+		{
+			for (uint o = 0; o < out_count; ++o)
+			{
+				_output[s * out_count + o] = batch[outputs[o] * _samples + s];
+			}
+		}
+
+		/// Leave the network in the state
+		/// produced by the last sample.
+		for (const uint i : live)
+		{
+			output[i] = batch[i * _samples + _samples - 1];
+		}
+	}
+
+	void Plan::eval_row(const uint _i, const std::vector<real>& _input, const uint _samples)
+	{
+		real* x(&batch[_i * _samples]);
+
+		if (folded[_i])
+		{
+			std::fill(x, x + _samples, value[_i]);
+			return;
+		}
+
+		switch (fn[_i])
+		{
+		case Fn::Min:
+		case Fn::Max:
+		case Fn::Avg:
+			for (uint s = 0; s < _samples; ++s)
+			{
+				OrderStat os;
+
+				if (ext[_i] != none)
+				{
+					os.add(_input[s * in_count + ext[_i]]);
+				}
+
+				for (uint l = fwd.offset[_i]; l < fwd.offset[_i + 1]; ++l)
+				{
+					const real src(batch[fwd.src[l] * _samples + s]);
+					if (src != 0.0)
+					{
+						os.add(src * fwd.weight[l]);
+					}
+				}
+
+				x[s] = os.get(fn[_i]);
+			}
+			break;
+
+		case Fn::Const:
+		case Fn::Golden:
+			Kernels::apply(fn[_i], x, _samples);
+			break;
+
+		default:
+			if (ext[_i] != none)
+			{
+				for (uint s = 0; s < _samples; ++s)
+				{
+					x[s] = _input[s * in_count + ext[_i]] + bias[_i];
+				}
+			}
+			else
+			{
+				std::fill(x, x + _samples, bias[_i]);
+			}
+
+			/// Each weight is loaded once per batch
+			for (uint l = fwd.offset[_i]; l < fwd.offset[_i + 1]; ++l)
+			{
+				const real w(fwd.weight[l]);
+				const real* src(&batch[fwd.src[l] * _samples]);
+				for (uint s = 0; s < _samples; ++s)
+				{
+					x[s] += src[s] * w;
+				}
+			}
+
+			Kernels::apply(fn[_i], x, _samples);
+		}
+	}
+}
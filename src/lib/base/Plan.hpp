@@ -0,0 +1,341 @@
+#ifndef PLAN_HPP
+#define PLAN_HPP
+
+#include "Config.hpp"
+#include "Param.hpp"
+
+namespace Cortex
+{
+	/// \brief Compiled evaluation plan for classical networks.
+	///
+	/// The plan is a flat snapshot of the evaluation graph.
+	/// Nodes are indexed by their position in the topological
+	/// order, and the incoming links of each node are stored
+	/// in compressed sparse row (CSR) form, so a forward pass
+	/// is a single sweep over contiguous arrays.
+	///
+	/// Nodes and links which cannot affect the outputs
+	/// (dead structure) are left out of the evaluation,
+	/// and constant subgraphs are folded into biases (cf. prune()),
+	/// although the structure remains part of the network.
+	///
+	/// The plan is rebuilt by Net::make_graph() after every
+	/// structural change. Parameter changes (weights and
+	/// transfer functions) only require a call to sync(),
+	/// which updates the affected part of the plan.
+	///
+	/// In delta mode, the activations of the last batch are kept.
+	/// sync() marks the nodes whose parameters have changed, and
+	/// evaluating the same batch again only recomputes those nodes
+	/// and the nodes downstream of them whose inputs have changed.
+	///
+	/// Recurrent links read the outputs of the previous step,
+	/// which are kept in a separate buffer (state) so that they
+	/// are not overwritten by the current step. The recurrent input
+	/// of all nodes is computed at the start of each step as a
+	/// single sparse matrix-vector product over that buffer.
+	///
+	/// The outgoing links of each node are built by route()
+	/// from all links. Spiking networks deliver spikes along them,
+	/// and sync() follows them to update folded constants and
+	/// Sum chains which depend on a changed parameter.
+	struct Plan
+	{
+		/// Marker for nodes which do not receive external input
+		static constexpr uint none = static_cast<uint>(-1);
+
+		/// Transfer function of each node
+		std::vector<Fn> fn;
+
+		/// Index into the external input vector
+		/// (or Plan::none for non-input nodes)
+		std::vector<uint> ext;
+
+		/// Links in compressed sparse row (CSR) form.
+		/// The sources of node i are stored in
+		/// [offset[i], offset[i + 1]).
+		struct Links
+		{
+			std::vector<uint> offset;
+			std::vector<uint> src;
+			std::vector<real> weight;
+
+			inline void clear()
+			{
+				offset.clear();
+				src.clear();
+				weight.clear();
+			}
+		};
+
+		/// All forward and recurrent links of the network,
+		/// in the order of fwd_params and rec_params.
+		struct
+		{
+			Links fwd;
+			Links rec;
+		} all;
+
+		/// Outgoing links of each node.
+		/// The targets of node i are stored in [offset[i], offset[i + 1]).
+		/// Each link refers to its position in all.fwd or, following
+		/// the forward links, in all.rec, so weight updates made
+		/// by sync() are visible without rebuilding the routes.
+		struct
+		{
+			std::vector<uint> offset;
+			std::vector<uint> tgt;
+			std::vector<uint> link;
+
+			inline void clear()
+			{
+				offset.clear();
+				tgt.clear();
+				link.clear();
+			}
+		} out;
+
+		/// Live forward and recurrent links (used for evaluation).
+		/// A link is dead if its weight is 0 (and the target does
+		/// not compute order statistics, which count such inputs)
+		/// or if its target does not contribute to the outputs.
+		Links fwd;
+		Links rec;
+
+		/// Nodes which contribute to the outputs
+		/// through live links, in topological order.
+		/// Dead nodes are not evaluated.
+		std::vector<uint> live;
+
+		/// Liveness of each node
+		std::vector<char> alive;
+
+		/// Nodes which contribute to the outputs through live
+		/// links before folding and collapsing (cf. alive).
+		/// Parameter changes of other nodes have no effect.
+		std::vector<char> needed;
+
+		/// Nodes whose output does not depend on the input
+		/// (e.g., bias nodes) are folded into constants.
+		/// Their contributions to other nodes are added to the
+		/// bias of those nodes instead of being stored as links.
+		std::vector<char> folded;
+		std::vector<real> value;
+
+		/// Sum chains (cf. prune()). Node i with via[i] != none
+		/// outputs scale[i] * output[via[i]] + shift[i].
+		std::vector<uint> via;
+		std::vector<real> scale;
+		std::vector<real> shift;
+
+		/// Constant term added to the input of each node
+		std::vector<real> bias;
+
+		/// Node outputs, indexed by position in the plan
+		std::vector<real> output;
+
+		/// Node outputs from the previous step, read by
+		/// recurrent links. The buffer is swapped with
+		/// output at the start of each step.
+		std::vector<real> state;
+
+		/// Recurrent input of each node in the current step
+		std::vector<real> recur;
+
+		/// Plan indices of the output nodes (ordered by NodeID.idx)
+		std::vector<uint> outputs;
+
+		/// Number of input nodes
+		uint in_count = 0;
+
+		/// Scratch space for batch evaluation.
+		/// In delta mode, the batch also serves as
+		/// the activation cache.
+		std::vector<real> batch;
+
+		/// Reuse the activations of the last batch
+		bool delta = false;
+
+		/// State of the activation cache
+		struct
+		{
+			/// The batch holds the activations for the input below
+			bool valid = false;
+
+			/// Input of the cached batch
+			std::vector<real> input;
+
+			/// Nodes whose parameters have changed since the batch was computed
+			std::vector<char> stale;
+
+			/// Nodes whose activations changed in the current pass
+			std::vector<char> changed;
+
+			/// Activations of a node before recomputing it
+			std::vector<real> prev;
+		} cache;
+
+		/// Scratch space for prune(): the work list and the
+		/// previous plan, for finding the nodes whose cached
+		/// activations are out of date. Kept between calls
+		/// so that pruning does not allocate.
+		/// pending marks the nodes to be visited by recompose().
+		struct
+		{
+			std::vector<uint> work;
+			std::vector<char> pending;
+			std::vector<char> alive;
+			std::vector<char> folded;
+			std::vector<real> value;
+			std::vector<real> bias;
+			Links fwd;
+		} scratch;
+
+		/// The nodes and link parameters which the
+		/// plan was compiled from. Used by sync().
+		std::vector<NodeRef> nodes;
+		std::vector<ParamRef> fwd_params;
+		std::vector<ParamRef> rec_params;
+
+		/// Compile the plan from a topologically sorted graph
+		void compile(const std::vector<NodeRef>& _graph, const bool _rec);
+
+		/// Reload weights and transfer functions
+		/// without recompiling the structure.
+		/// The plan is only pruned again if a change
+		/// makes links or nodes live or dead. Other changes
+		/// are applied to the live links in place.
+		void sync();
+
+		/// Reload the parameters which a mutation of a single
+		/// node can change: its transfer function, its incoming
+		/// links and the incoming links of its targets (weight
+		/// mutations can pick an outgoing link). The cost is
+		/// proportional to the number of links of those nodes.
+		void sync(const Node& _node);
+
+		/// Reload the parameters of node i.
+		/// Returns true if the plan has to be pruned again.
+		bool reload(const uint _i);
+
+		/// Recompute the live links and the bias of node i
+		/// after a weight change which leaves the structure
+		/// of the plan as it is.
+		void relink(const uint _i);
+
+		/// Output of a folded node (cf. prune())
+		real fold(const uint _i) const;
+
+		/// Make node i part of a Sum chain
+		/// if it has a single variable input.
+		void compose(const uint _i);
+
+		/// Recompute the folded value or the chain composition
+		/// of node i and of the folded and collapsed nodes which
+		/// depend on it, and relink the live nodes they feed.
+		/// The structure of the plan does not change.
+		void recompose(const uint _i);
+
+		void eval(const std::vector<real>& _input);
+
+		/// Evaluate one step for the input starting at _input
+		/// (in_count values). Recurrent links see the outputs
+		/// of the previous step.
+		void step(const real* _input);
+
+		/// Forget the outputs of earlier steps so that
+		/// recurrent networks start from rest.
+		inline void reset_state()
+		{
+			std::fill(output.begin(), output.end(), 0.0);
+			std::fill(state.begin(), state.end(), 0.0);
+		}
+
+		/// Evaluate a batch of independent samples.
+		/// The input is a row-major (samples x inputs) matrix,
+		/// and the output is written as a row-major
+		/// (samples x outputs) matrix.
+		void eval_batch(const std::vector<real>& _input, const uint _samples, std::vector<real>& _output);
+
+		/// Compute the activations of node i for all samples in the batch
+		void eval_row(const uint _i, const std::vector<real>& _input, const uint _samples);
+
+		/// Build the outgoing links from all links
+		void route();
+
+		/// Weight of a link given its position in all.fwd or,
+		/// following the forward links, in all.rec
+		inline real link_weight(const uint _link) const
+		{
+			return (_link < all.fwd.weight.size() ? all.fwd.weight[_link] : all.rec.weight[_link - all.fwd.weight.size()]);
+		}
+
+		/// Weight of an outgoing link
+		inline real out_weight(const uint _l) const
+		{
+			return link_weight(out.link[_l]);
+		}
+
+		/// Change the weight of a link (cf. link_weight()) in the plan
+		/// and in the network. Used by spiking networks, which only
+		/// evaluate all links, so the live links are not updated.
+		inline void set_weight(const uint _link, const real _weight)
+		{
+			if (_link < all.fwd.weight.size())
+			{
+				all.fwd.weight[_link] = _weight;
+				fwd_params[_link].get().set(_weight);
+			}
+			else
+			{
+				all.rec.weight[_link - all.fwd.weight.size()] = _weight;
+				rec_params[_link - all.fwd.weight.size()].get().set(_weight);
+			}
+		}
+
+		/// Optimise the plan: find the live nodes and links,
+		/// fold constant nodes into biases and collapse chains
+		/// of Sum nodes with a single variable input into
+		/// direct links. The links used for evaluation are
+		/// rebuilt from all links. Called by compile() and
+		/// by sync() if the live structure has changed.
+		void prune();
+
+		inline uint size() const
+		{
+			return fn.size();
+		}
+
+		inline void clear()
+		{
+			fn.clear();
+			ext.clear();
+			all.fwd.clear();
+			all.rec.clear();
+			out.clear();
+			fwd.clear();
+			rec.clear();
+			live.clear();
+			alive.clear();
+			needed.clear();
+			folded.clear();
+			value.clear();
+			via.clear();
+			scale.clear();
+			shift.clear();
+			bias.clear();
+			output.clear();
+			state.clear();
+			recur.clear();
+			outputs.clear();
+			in_count = 0;
+			cache.valid = false;
+			cache.stale.clear();
+			nodes.clear();
+			fwd_params.clear();
+			rec_params.clear();
+		}
+	};
+}
+
+#endif // PLAN_HPP
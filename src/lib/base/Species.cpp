@@ -56,7 +56,7 @@ namespace Cortex
 		std::vector<uint> mutable_nets;
 		for (const auto& n : pop.rank.unfit)
 		{
-			mutable_nets.emplace_back(n.first);
+			mutable_nets.emplace_back(n);
 		}
 		return mutable_nets;
 	}
@@ -118,13 +118,13 @@ namespace Cortex
 			net.second.get().set_rel_fitness(rel_fit);
 			pop.fit.rel.add(rel_fit);
 
-			pop.rank.fit.emplace(net.first, rel_fit);
-			pop.rank.unfit.emplace(net.first, 1.0 - rel_fit);
+			pop.rank.fit.set(net.first, rel_fit);
+			pop.rank.unfit.set(net.first, 1.0 - rel_fit);
 
 			dlog() << "Network " << net.second.get().id << ":"
 				   << "\n\tabs fitness: " << net.second.get().get_abs_fitness()
 				   << "\n\trel fitness: " << net.second.get().get_rel_fitness()
-				   << "\n\tunfitness: " << pop.rank.unfit.at(net.second.get().id);
+				   << "\n\tunfitness: " << pop.rank.unfit.weight(net.second.get().id);
 		}
 
 		if (cfg.mutation.elitism.enabled &&
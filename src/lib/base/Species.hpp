@@ -5,46 +5,35 @@
 
 namespace Cortex
 {
+	/// Number of nodes for each node role.
+	/// Stored inline (one count per role) so that genotypes
+	/// are cheap to copy, compare and hash.
 	class Genotype
 	{
 	private:
 
-		emap<NR, uint> genome;
+		etable<NR, uint> genome;
 
 	public:
 
 		Genotype(const emap<NR, uint>& _genome)
 		{
-			for (const auto& nr : Enum<NR>::entries)
+			for (auto& gene : genome)
 			{
-				if (_genome.find(nr.first) != _genome.end())
-				{
-					genome[nr.first] = _genome.at(nr.first);
-				}
-				else
-				{
-					genome[nr.first] = 0;
-				}
+				auto it(_genome.find(gene.first));
+				gene.second = (it == _genome.end() ? 0 : it->second);
 			}
 		}
 
 		inline bool add(const NR _nr, const uint _count = 1)
 		{
-			if (genome.find(_nr) == genome.end())
-			{
-				genome.emplace(_nr, _count);
-			}
-			else
-			{
-				genome.at(_nr) += _count;
-			}
+			genome.at(_nr) += _count;
 			return true;
 		}
 
 		inline bool erase(const NR _nr, const uint _count = 1)
 		{
-			if (genome.find(_nr) == genome.end() ||
-				genome.at(_nr) < _count)
+			if (genome.at(_nr) < _count)
 			{
 				return false;
 			}
@@ -52,7 +41,7 @@ namespace Cortex
 			return true;
 		}
 
-		inline uint count(const NR _nr)
+		inline uint count(const NR _nr) const
 		{
 			return genome.at(_nr);
 		}
@@ -62,18 +51,35 @@ namespace Cortex
 			return genome;
 		}
 
-		inline bool operator == (const Genotype& _other)
+		inline bool operator == (const Genotype& _other) const
 		{
 			for (const auto& gene : genome)
 			{
-				if (_other.genome.find(gene.first) == _other.genome.end() ||
-					gene.second != _other.genome.at(gene.first))
+				if (gene.second != _other.genome.at(gene.first))
 				{
 					return false;
 				}
 			}
 			return true;
 		}
+
+		inline std::size_t hash() const
+		{
+			std::size_t h(0);
+			for (const auto& gene : genome)
+			{
+				h ^= std::hash<uint>()(gene.second) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+			}
+			return h;
+		}
+	};
+
+	struct GenotypeHash
+	{
+		inline std::size_t operator()(const Genotype& _gen) const
+		{
+			return _gen.hash();
+		}
 	};
 
 	class Species
@@ -109,13 +115,16 @@ namespace Cortex
 			/// Elite networks
 			std::vector<uint> elite;
 
+			/// Roulette wheels for selecting parents
+			/// and networks to cull. Kept up to date
+			/// as networks are erased.
 			struct
 			{
 				/// Network ID => relative fitness
-				emap<uint, real> fit;
+				Wheel<uint> fit;
 
 				/// Network ID => unfitness.
-				emap<uint, real> unfit;
+				Wheel<uint> unfit;
 			} rank;
 
 			struct
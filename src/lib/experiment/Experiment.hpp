@@ -1,7 +1,7 @@
 #ifndef EXPERIMENT_HPP
 #define EXPERIMENT_HPP
 
-#include "Ecosystem.hpp"
+#include "Archipelago.hpp"
 
 namespace Cortex
 {
@@ -18,46 +18,102 @@ namespace Cortex
 		template<typename F, typename ... Args>
 		inline void add(Config& _config, F&& _eval_func, Args&& ... _args)
 		{
-			ecosystems.push_back(std::thread([&]
+			/// The configuration is shared by all runs,
+			/// so it is validated once before they start.
+			if (!_config.validate())
+			{
+				dlog() << "Invalid configuration, exiting...";
+				exit(EXIT_FAILURE);
+			}
+
+			ecosystems.push_back(std::thread([&, eval_func = _eval_func]
 			{
 				dlog() << "Experiment created in thread " << std::this_thread::get_id() << "\n";
 
-				uint runs(_config.runs);
-				uint run(1);
-				uint successes(0);
-				std::vector<uint> evals;
-				std::vector<uint> gens;
-				std::vector<uint> hidden_nodes;
+				const uint runs(_config.runs);
 
-				while (run <= runs)
+				/// Outcome of each run, indexed by run
+				struct Result
 				{
-					Ecosystem es(_config);
-
-					if (!es.init())
+					bool solved = false;
+					uint evals = 0;
+					uint gens = 0;
+					uint hidden_nodes = 0;
+				};
+				std::vector<Result> results(runs);
+
+				/// The threadpool is shared by all runs
+				ThreadPool tp(_config.threads);
+
+				/// Runs are handed out to a number of runners.
+				/// Each runner evolves one run (archipelago) at a time
+				/// and submits its evaluations to the shared threadpool,
+				/// so the pool stays busy while a run is
+				/// evolving its population or finishing a generation.
+				std::atomic<uint> next_run(0);
+
+				auto runner([&]
+				{
+					uint run(0);
+					while ((run = next_run.fetch_add(1)) < runs)
 					{
-						dlog() << "Error initialising the ecosystem, exiting...";
-						exit(EXIT_FAILURE);
-					}
+						Archipelago arch(_config, tp, run + 1);
 
-					dlog() << "\n################\n"
-						   << "Run " << run << " / " << runs
-						   << "\n################\n\n";
+						if (!arch.init())
+						{
+							dlog() << "Error initialising the ecosystem, exiting...";
+							exit(EXIT_FAILURE);
+						}
 
-					while (es.get_age() <= _config.ecosystem.max.age)
-					{
-						es.eval(std::forward<F>(_eval_func), std::forward<Args>(_args)...);
-						if ( es.is_solved() )
+						dlog() << "\n################\n"
+							   << "Run " << run + 1 << " / " << runs
+							   << "\n################\n\n";
+
+						arch.evolve(eval_func, _args...);
+
+						if (arch.is_solved())
 						{
-							++successes;
-							evals.push_back(es.total_evals());
-							gens.push_back(es.get_age());
-							hidden_nodes.push_back(es.champ().node_count(NR::H));
+							Ecosystem& es(arch.get_winner());
 
-							break;
+							Result& res(results[run]);
+							res.solved = true;
+							res.evals = arch.total_evals();
+							res.gens = es.get_age();
+							res.hidden_nodes = es.champ().node_count(NR::H);
 						}
 					}
+				});
 
-					++run;
+				uint concurrent(_config.concurrent_runs == 0 ? tp.worker_count() : _config.concurrent_runs);
+				concurrent = std::max<uint>(1, std::min(concurrent, runs));
+
+				/// The experiment thread is one of the runners
+				std::vector<std::thread> runners;
+				for (uint r = 1; r < concurrent; ++r)
+				{
+					runners.emplace_back(runner);
+				}
+				runner();
+
+				for (auto& r : runners)
+				{
+					r.join();
+				}
+
+				uint successes(0);
+				std::vector<uint> evals;
+				std::vector<uint> gens;
+				std::vector<uint> hidden_nodes;
+
+				for (const auto& res : results)
+				{
+					if (res.solved)
+					{
+						++successes;
+						evals.push_back(res.evals);
+						gens.push_back(res.gens);
+						hidden_nodes.push_back(res.hidden_nodes);
+					}
 				}
 
 				dlog stats;
@@ -0,0 +1,56 @@
+#include "Arena.hpp"
+
+namespace Cortex
+{
+	constexpr std::size_t Arena::granularity;
+	constexpr std::size_t Arena::classes;
+	constexpr std::size_t Arena::chunk_size;
+
+	void* Arena::allocate(const std::size_t _bytes)
+	{
+		const std::size_t cls((_bytes + granularity - 1) / granularity);
+
+		if (cls == 0 ||
+			cls > classes)
+		{
+			return ::operator new(_bytes);
+		}
+
+		/// Reuse a block of the same size class
+		if (free_list[cls - 1])
+		{
+			Block* block(free_list[cls - 1]);
+			free_list[cls - 1] = block->next;
+			return block;
+		}
+
+		const std::size_t size(cls * granularity);
+		if (left < size)
+		{
+			chunks.emplace_back(new char[chunk_size]);
+			head = chunks.back().get();
+			left = chunk_size;
+		}
+
+		void* ptr(head);
+		head += size;
+		left -= size;
+		return ptr;
+	}
+
+	void Arena::deallocate(void* _ptr, const std::size_t _bytes)
+	{
+		const std::size_t cls((_bytes + granularity - 1) / granularity);
+
+		if (cls == 0 ||
+			cls > classes)
+		{
+			::operator delete(_ptr);
+			return;
+		}
+
+		Block* block(static_cast<Block*>(_ptr));
+		block->next = free_list[cls - 1];
+		free_list[cls - 1] = block;
+	}
+}
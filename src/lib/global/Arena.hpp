@@ -0,0 +1,150 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstddef>
+
+namespace Cortex
+{
+	/// \brief Memory arena for small objects.
+	///
+	/// Memory is carved out of large chunks and recycled
+	/// through free lists, one for each size class
+	/// (multiples of 16 bytes up to 2 KiB).
+	/// Larger requests are passed on to the global allocator.
+	/// All chunks are released in one go when the arena
+	/// is destroyed, so every object allocated from it
+	/// must be destroyed before the arena.
+	///
+	/// An arena is not thread-safe. Each network owns one,
+	/// and a network is only modified by one thread at a time.
+	class Arena
+	{
+	public:
+
+		Arena() = default;
+
+		Arena(const Arena& _other) = delete;
+
+		Arena(Arena&& _other) = delete;
+
+		Arena& operator = (const Arena& _other) = delete;
+
+		void* allocate(const std::size_t _bytes);
+
+		void deallocate(void* _ptr, const std::size_t _bytes);
+
+		/// Construct an object in the arena
+		template<typename T, typename ... Args>
+		inline T* make(Args&& ... _args)
+		{
+			return new (allocate(sizeof(T))) T(std::forward<Args>(_args)...);
+		}
+
+		/// Destroy an object and return its memory to the arena
+		template<typename T>
+		inline void destroy(T* _ptr)
+		{
+			if (_ptr)
+			{
+				_ptr->~T();
+				deallocate(_ptr, sizeof(T));
+			}
+		}
+
+	private:
+
+		static constexpr std::size_t granularity = 16;
+		static constexpr std::size_t classes = 128;
+		static constexpr std::size_t chunk_size = 32768;
+
+		struct Block
+		{
+			Block* next;
+		};
+
+		std::vector<std::unique_ptr<char[]>> chunks;
+
+		/// Unused space in the current chunk
+		char* head = nullptr;
+		std::size_t left = 0;
+
+		Block* free_list[classes] = {};
+	};
+
+	/// Deleter for std::unique_ptr holding
+	/// an object allocated from an arena.
+	template<typename T>
+	struct ArenaDeleter
+	{
+		Arena* arena = nullptr;
+
+		inline void operator()(T* _ptr) const
+		{
+			arena->destroy(_ptr);
+		}
+	};
+
+	template<typename T>
+	using ArenaPtr = std::unique_ptr<T, ArenaDeleter<T>>;
+
+	template<typename T, typename ... Args>
+	inline ArenaPtr<T> make_arena_ptr(Arena& _arena, Args&& ... _args)
+	{
+		return ArenaPtr<T>(_arena.make<T>(std::forward<Args>(_args)...), ArenaDeleter<T>{&_arena});
+	}
+
+	/// Standard allocator interface to an arena.
+	/// Used by the containers which hold the links of a node.
+	template<typename T>
+	struct ArenaAllocator
+	{
+		using value_type = T;
+
+		/// The allocator follows the container
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		Arena* arena = nullptr;
+
+		ArenaAllocator() = default;
+
+		explicit ArenaAllocator(Arena& _arena)
+			:
+			  arena(&_arena)
+		{}
+
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& _other)
+			:
+			  arena(_other.arena)
+		{}
+
+		inline T* allocate(const std::size_t _n)
+		{
+			return static_cast<T*>(arena->allocate(_n * sizeof(T)));
+		}
+
+		inline void deallocate(T* _ptr, const std::size_t _n)
+		{
+			arena->deallocate(_ptr, _n * sizeof(T));
+		}
+
+		template<typename U>
+		inline bool operator == (const ArenaAllocator<U>& _other) const
+		{
+			return arena == _other.arena;
+		}
+
+		template<typename U>
+		inline bool operator != (const ArenaAllocator<U>& _other) const
+		{
+			return arena != _other.arena;
+		}
+	};
+}
+
+#endif // ARENA_HPP
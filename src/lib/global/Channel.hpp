@@ -0,0 +1,96 @@
+#ifndef CHANNEL_HPP
+#define CHANNEL_HPP
+
+#include <atomic>
+#include <vector>
+
+#include "Globals.hpp"
+
+namespace Cortex
+{
+	/// \brief Bounded lock-free channel between
+	/// a single producer and a single consumer.
+	///
+	/// The items are kept in a ring buffer whose
+	/// capacity is rounded up to a power of 2.
+	/// The producer only writes the tail index and
+	/// the consumer only writes the head index,
+	/// so neither side ever waits for the other.
+	template<typename T>
+	class Channel
+	{
+	private:
+
+		std::vector<T> slots;
+
+		const uint mask;
+
+		/// Next slot to read (consumer only)
+		std::atomic<uint> head;
+
+		/// Next slot to write (producer only)
+		std::atomic<uint> tail;
+
+		static inline uint round_up(const uint _capacity)
+		{
+			uint capacity(1);
+			while (capacity < _capacity)
+			{
+				capacity <<= 1;
+			}
+			return capacity;
+		}
+
+	public:
+
+		explicit Channel(const uint _capacity)
+			:
+			  slots(round_up(std::max<uint>(_capacity, 1))),
+			  mask(slots.size() - 1),
+			  head(0),
+			  tail(0)
+		{}
+
+		Channel(const Channel& _other) = delete;
+
+		Channel& operator = (const Channel& _other) = delete;
+
+		/// Producer only.
+		/// Returns false if the channel is full,
+		/// in which case the item is left untouched.
+		inline bool push(T&& _item)
+		{
+			const uint t(tail.load(std::memory_order_relaxed));
+			if (t - head.load(std::memory_order_acquire) == slots.size())
+			{
+				return false;
+			}
+
+			slots[t & mask] = std::move(_item);
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Consumer only.
+		/// Returns false if the channel is empty.
+		inline bool pop(T& _item)
+		{
+			const uint h(head.load(std::memory_order_relaxed));
+			if (h == tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			_item = std::move(slots[h & mask]);
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+		inline bool empty() const
+		{
+			return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+		}
+	};
+}
+
+#endif // CHANNEL_HPP
@@ -29,12 +29,12 @@ namespace Cortex
 	}
 
 	template<typename E, typename std::enable_if< std::is_enum<E>::value, E>::type ...>
-	void from_json( const json& _j, E _enum )
+	void from_json( const json& _j, E& _enum )
 	{
 		_enum = as_enum<E>(_j.get<std::string>());
 		if (_enum == Enum<E>::undef)
 		{
-			dlog() << "Invalid enum entry '" << _enum << "'";
+			dlog() << "Invalid enum entry '" << _j.get<std::string>() << "'";
 			exit(EXIT_FAILURE);
 		}
 	}
@@ -61,10 +61,18 @@ namespace Cortex
 
 		/// Ecosystem
 		load("ecosystem.search", ecosystem.search);
+		load("ecosystem.sched", ecosystem.sched);
+		load("ecosystem.timed", ecosystem.timed);
 		load("ecosystem.init.size", ecosystem.init.size);
 		load("ecosystem.max.size", ecosystem.max.size);
 		load("ecosystem.max.age", ecosystem.max.age);
 
+		/// Islands
+		load("islands.count", islands.count);
+		load("islands.topology", islands.topology);
+		load("islands.interval", islands.interval);
+		load("islands.migrants", islands.migrants);
+
 		/// Species
 		load("species.init.count", species.init.count);
 		load("species.max.count", species.max.count);
@@ -72,10 +80,14 @@ namespace Cortex
 		/// Nets
 		load("net.type", net.type);
 		load("net.rf", net.rf);
+		load("net.delta", net.delta);
 		load("net.spiking.enc", net.spiking.enc);
 		load("net.spiking.beta", net.spiking.beta);
+		load("net.spiking.ranges", net.spiking.ranges);
 		load("net.spiking.mod", net.spiking.mod);
+		load("net.spiking.sim", net.spiking.sim);
 		load("net.spiking.timestep", net.spiking.timestep);
+		load("net.spiking.delay", net.spiking.delay);
 		load("net.spiking.max.latency", net.spiking.max.latency);
 		load("net.max.age", net.max.age);
 
@@ -116,6 +128,7 @@ namespace Cortex
 
 		/// Fitness
 		load("fit.tgt", fit.tgt);
+		load("fit.deterministic", fit.deterministic);
 		load("fit.ema.coeff", fit.ema.coeff);
 
 		/// STDP
@@ -131,7 +144,16 @@ namespace Cortex
 
 		/// Others
 		load("runs", runs);
+		load("concurrent_runs", concurrent_runs);
 		load("threads", threads);
+		load("seed", seed);
+
+		if (seed == 0)
+		{
+			seed = static_cast<ulong>( std::chrono::high_resolution_clock::now().time_since_epoch().count() );
+		}
+		rng.seed(seed);
+		dlog() << "Random seed: " << seed;
 
 		dlog() << "Configuration loaded successfully!\n" << config_json.dump(4);
 	}
@@ -174,28 +196,34 @@ namespace Cortex
 
 	Config::Config(const std::string& _config_file)
 		:
-		  config_file(_config_file),
-		  species_id(0),
-		  net_id(0)
+		  config_file(_config_file)
 	{
 		dlog() << "\n##### Cortex neuroevolution platform v. " << version << " #####\n";
 
-		rng.engine.seed( static_cast<ulong>( std::chrono::high_resolution_clock::now().time_since_epoch().count() ) );
-
 		ecosystem.search = Search::Fitness;
+		ecosystem.sched = Sched::Chunked;
+		ecosystem.timed = false;
 		ecosystem.init.size = 50;
 		ecosystem.max.size = 200;
 		ecosystem.max.age = 1000;
 
+		islands.count = 1;
+		islands.topology = Topology::Ring;
+		islands.interval = 10;
+		islands.migrants = 2;
+
 		species.init.count = 3;
 		species.max.count = 15;
 
 		net.type = NT::Classical;
+		net.delta = false;
 		net.rf = RF::Undef;
 		net.spiking.enc = Enc::Rank;
 		net.spiking.beta = 1.5;
 		net.spiking.mod = 0.9;
-		net.spiking.timestep = 10.0;
+		net.spiking.sim = Sim::Event;
+		net.spiking.timestep = 1.0;
+		net.spiking.delay = 1.0;
 		net.spiking.max.latency = 70.0;
 		net.max.age = 0;
 
@@ -270,6 +298,7 @@ namespace Cortex
 		mutation.elitism.prop = 0.05;
 
 		fit.tgt = 0.0;
+		fit.deterministic = false;
 		fit.ema.coeff = 0.25;
 
 		stdp.enabled = false;
@@ -282,7 +311,9 @@ namespace Cortex
 		novelty.hist_size = 100;
 
 		runs = 1;
+		concurrent_runs = 0;
 		threads = std::thread::hardware_concurrency();
+		seed = 0;
 
 		load();
 	}
@@ -297,6 +328,29 @@ namespace Cortex
 			problems << "\t - Initial ecosystem size set to 0.\n";
 		}
 
+		if (ecosystem.sched == Sched::Undef)
+		{
+			problems << "\t - Missing scheduling policy.\n";
+		}
+
+		if (islands.count == 0)
+		{
+			problems << "\t - Number of islands set to 0.\n";
+		}
+
+		if (islands.count > 1)
+		{
+			if (islands.topology == Topology::Undef)
+			{
+				problems << "\t - Missing migration topology.\n";
+			}
+
+			if (islands.interval == 0)
+			{
+				problems << "\t - Migration interval set to 0.\n";
+			}
+		}
+
 		if (species.init.count == 0)
 		{
 			problems << "\t - Initial species count set to 0.\n";
@@ -332,6 +386,65 @@ namespace Cortex
 		{
 			/// Disable transfer function mutation.
 			mutation.prob.erase(Mut::Fn);
+
+			if (net.spiking.delay <= 0.0)
+			{
+				problems << "\t - Spike delay must be positive.\n";
+			}
+
+			if (net.spiking.sim == Sim::Undef)
+			{
+				problems << "\t - Missing spiking simulation method.\n";
+			}
+			else if (net.spiking.sim == Sim::Clock &&
+					 net.spiking.timestep <= 0.0)
+			{
+				problems << "\t - Time step must be positive.\n";
+			}
+
+			if (net.rf == RF::GRF &&
+				!net.spiking.ranges.empty())
+			{
+				if (node.roles.at(NR::I) % net.spiking.ranges.size() != 0)
+				{
+					problems << "\t - Number of input nodes is not a multiple of the number of variables.\n";
+				}
+				else if (node.roles.at(NR::I) / net.spiking.ranges.size() < 3)
+				{
+					problems << "\t - Gaussian receptive fields require at least 3 input nodes per variable.\n";
+				}
+
+				for (const auto& range : net.spiking.ranges)
+				{
+					if (range.second <= range.first)
+					{
+						problems << "\t - Invalid variable range [" << range.first << ", " << range.second << "].\n";
+					}
+				}
+
+				if (net.spiking.beta <= 0.0)
+				{
+					problems << "\t - Receptive field beta must be positive.\n";
+				}
+			}
+
+			if (stdp.enabled)
+			{
+				if (stdp.span <= 0.0)
+				{
+					problems << "\t - STDP time span must be positive.\n";
+				}
+
+				if (stdp.lr < 0.0)
+				{
+					problems << "\t - STDP learning rate must be non-negative.\n";
+				}
+
+				if (stdp.alpha < 0.0)
+				{
+					problems << "\t - STDP alpha must be non-negative.\n";
+				}
+			}
 		}
 		else
 		{
@@ -400,9 +513,73 @@ namespace Cortex
 			return false;
 		}
 
+		build_samplers();
+
+		grf.clear();
+		if (net.type == NT::Spiking &&
+			net.rf == RF::GRF &&
+			!net.spiking.ranges.empty())
+		{
+			grf.setup(net.spiking.ranges, node.roles.at(NR::I) / net.spiking.ranges.size(), net.spiking.beta);
+		}
+
 		return true;
 	}
 
+	bool Config::setup_grf(const std::vector<std::pair<real, real>>& _ranges)
+	{
+		net.spiking.ranges = _ranges;
+		return validate();
+	}
+
+	void Config::build_samplers()
+	{
+		samplers.link.type.build(link.type);
+
+		samplers.link.roles.clear();
+		samplers.link.tgt.clear();
+		samplers.link.src.clear();
+		for (const auto& lt : link.prob)
+		{
+			std::map<std::pair<NR, NR>, real> role_map;
+			for (const auto& srole : lt.second)
+			{
+				for (const auto& trole : srole.second)
+				{
+					role_map[{srole.first, trole.first}] = trole.second;
+				}
+			}
+			samplers.link.roles[lt.first].build(role_map);
+		}
+
+		if (link.prob.find(LT::F) != link.prob.end())
+		{
+			emap<NR, emap<NR, real>> src_roles;
+			for (const auto& srole : link.prob.at(LT::F))
+			{
+				samplers.link.tgt[srole.first].build(srole.second);
+				for (const auto& trole : srole.second)
+				{
+					src_roles[trole.first].emplace(srole.first, trole.second);
+				}
+			}
+
+			for (const auto& trole : src_roles)
+			{
+				samplers.link.src[trole.first].build(trole.second);
+			}
+		}
+
+		samplers.mutation.prob.build(mutation.prob);
+		samplers.mutation.node.build(mutation.node);
+
+		samplers.mutation.fn.clear();
+		for (const auto& role : mutation.fn)
+		{
+			samplers.mutation.fn[role.first].build(role.second);
+		}
+	}
+
 	bool traverse(json& _j, json::iterator& _it, const std::string& _param)
 	{
 		std::deque<std::string> keys(get_keys(_param));
@@ -5,6 +5,10 @@
 #include <chrono>
 
 #include "Stat.hpp"
+#include "Rng.hpp"
+#include "Sampler.hpp"
+#include "Wheel.hpp"
+#include "GRF.hpp"
 #include "json.hpp"
 
 namespace Cortex
@@ -48,21 +52,17 @@ namespace Cortex
 
 		json config_json;
 
-		uint species_id;
-		uint net_id;
-
 		void load();
 
 		bool parse_json();
 
-		struct
-		{
-			/// \brief 64-bit Mersenne twister RNG.
-			std::mt19937_64 engine;
+		/// Build the alias tables for the probability tables
+		void build_samplers();
 
-			/// RNG mutex
-			std::mutex mtx;
-		} rng;
+		/// Master random number stream.
+		/// Used by the thread which drives the experiment
+		/// and for seeding the streams of the networks.
+		Rng rng;
 
 	public:
 
@@ -102,6 +102,18 @@ namespace Cortex
 			/// Search mode to use (fitness, novelty, etc.)
 			Search search;
 
+			/// Policy for scheduling network evaluations
+			Sched sched;
+
+			/// Estimate the cost of evaluating a network
+			/// (for the LPT and chunked policies) from the measured
+			/// duration of its last evaluation rather than from its size.
+			/// Measured times vary between runs, and so does the order
+			/// of evaluation, which determines the networks evaluated
+			/// before the task is solved. Runs are therefore not
+			/// reproducible even with a fixed seed.
+			bool timed;
+
 			struct
 			{
 				/// Initial number of networks.
@@ -118,6 +130,24 @@ namespace Cortex
 			} max;
 		} ecosystem;
 
+		/// Island model: several ecosystems are evolved
+		/// concurrently and periodically exchange their best networks.
+		struct
+		{
+			/// Number of islands (1 disables the island model)
+			uint count;
+
+			/// Which islands receive migrants from which
+			Topology topology;
+
+			/// Number of generations between migrations
+			uint interval;
+
+			/// Number of networks sent by each island
+			/// to each of its neighbours
+			uint migrants;
+		} islands;
+
 		struct
 		{
 			struct
@@ -142,6 +172,13 @@ namespace Cortex
 			/// Receptive field type
 			RF rf;
 
+			/// Cache the activations of all nodes for the
+			/// last batch of samples and only recompute the nodes
+			/// affected by a parameter mutation when the same
+			/// batch is evaluated again (e.g., a fixed training set).
+			/// Only applies to classical networks without recurrent links.
+			bool delta;
+
 			struct
 			{
 				/// The type of spike encoding determines
@@ -151,13 +188,27 @@ namespace Cortex
 				/// Beta parameter for Gaussian receptive fields
 				real beta;
 
+				/// Range (min, max) of each input variable
+				/// for Gaussian receptive fields. The input nodes
+				/// are split evenly between the variables.
+				std::vector<std::pair<real, real>> ranges;
+
 				/// Parameter for computing node
 				/// activation in the case of rank order encoding
 				real mod;
 
-				/// The default time step for evaluation.
+				/// Event-driven simulation is efficient when spikes
+				/// are sparse, whereas clock-driven simulation
+				/// updates all nodes in every time step and wins
+				/// when activity is dense (cf. the spike_bench binary).
+				Sim sim;
+
+				/// The time step for clock-driven simulation.
 				real timestep;
 
+				/// Time taken by a spike to travel along a link
+				real delay;
+
 				/// Maximal spiking latency
 				struct
 				{
@@ -273,6 +324,15 @@ namespace Cortex
 			/// networks are striving towards.
 			real tgt;
 
+			/// The fitness depends only on the structure
+			/// and parameters of the network (e.g., XOR),
+			/// so networks which have not changed since
+			/// their last evaluation keep their fitness.
+			/// Their fitness statistics are updated as if
+			/// they had been evaluated again, so the switch
+			/// saves evaluations without changing the search.
+			bool deterministic;
+
 			struct
 			{
 				/// Coefficient for tracking the exponential
@@ -315,13 +375,68 @@ namespace Cortex
 		/// Number of experiments
 		uint runs;
 
+		/// Number of runs evolved concurrently.
+		/// The runs share the threadpool.
+		/// 0 (the default) uses as many as there are threads.
+		uint concurrent_runs;
+
+		/// Alias tables for the static probability tables
+		/// (link types, link roles, mutations, etc.).
+		/// Rebuilt by validate() so that they reflect
+		/// any adjustments made to the tables.
+		struct
+		{
+			struct
+			{
+				/// Link types
+				Sampler<LT> type;
+
+				/// Source and target roles by link type
+				emap<LT, Sampler<std::pair<NR, NR>>> roles;
+
+				/// Forward link targets by source role
+				emap<NR, Sampler<NR>> tgt;
+
+				/// Forward link sources by target role
+				emap<NR, Sampler<NR>> src;
+			} link;
+
+			struct
+			{
+				/// Mutation types
+				Sampler<Mut> prob;
+
+				/// Node roles
+				Sampler<NR> node;
+
+				/// Transfer functions by node role
+				emap<NR, Sampler<Fn>> fn;
+			} mutation;
+		} samplers;
+
+		/// Gaussian receptive fields shared by all networks.
+		/// Rebuilt by validate() when net.rf is GRF.
+		GRF grf;
+
 		/// Number of threads in the threadpool
 		uint threads;
 
+		/// Seed for all random number streams.
+		/// 0 (the default) picks a seed based on the time,
+		/// which is logged so that the run can be reproduced.
+		ulong seed;
+
 		Config(const std::string& _config_file);
 
 		bool validate();
 
+		/// Set the ranges of the input variables
+		/// and rebuild the receptive fields.
+		/// The ranges are usually only known to the task,
+		/// so it is not necessary to list them in the
+		/// configuration file.
+		bool setup_grf(const std::vector<std::pair<real, real>>& _ranges);
+
 		template<typename T>
 		inline T get_custom_val( const std::string& _keys )
 		{
@@ -335,40 +450,33 @@ namespace Cortex
 			return config_json;
 		}
 
-		inline uint new_spc_id()
-		{
-			return ++species_id;
-		}
-
-		inline uint new_net_id()
-		{
-			return ++net_id;
-		}
+		/// Functions returning random numbers, elements, etc.
+		/// They draw from the stream which is active in the
+		/// calling thread (see Rng::Scope) or from the master
+		/// stream if there is none, so no locking is required
+		/// as long as each stream is used by one thread at a time.
 
-		inline void reset_ids()
+		/// The stream used by the calling thread
+		inline Rng& stream()
 		{
-			species_id = 0;
-			net_id = 0;
+			Rng* active(Rng::active());
+			return active ? *active : rng;
 		}
 
-		/// Functions returning random numbers, elements, etc.
-
 		/// Random integer drawn from a uniform distribution
 		template<typename T = uint, typename std::enable_if<std::is_integral<T>::value>::type ...>
 		inline T rnd_int(const T _min, const T _max)
 		{
-			glock lk(rng.mtx);
 			std::uniform_int_distribution<T> dist(_min, _max);
-			return dist(rng.engine);
+			return dist(stream());
 		}
 
 		/// Random real number drawn from a uniform distribution
 		template<typename T = real, typename std::enable_if<std::is_floating_point<T>::value>::type ...>
 		inline real rnd_real(const real _min, const real _max)
 		{
-			glock lk(rng.mtx);
 			std::uniform_real_distribution<real> dist(_min, _max);
-			return dist(rng.engine);
+			return dist(stream());
 		}
 
 		/// Chance
@@ -380,16 +488,33 @@ namespace Cortex
 		/// Random number drawn from a normal distribution
 		inline real rnd_nd(const real _mean, const real _sd)
 		{
-			glock lk(rng.mtx);
 			std::normal_distribution<real> dist(_mean, _sd);
-			return dist(rng.engine);
+			return dist(stream());
+		}
+
+		/// Random key drawn from a precomputed alias table
+		template<typename K>
+		inline K w_dist(const Sampler<K>& _sampler)
+		{
+			return _sampler(stream());
 		}
 
+		/// Random key drawn from a roulette wheel
+		template<typename K>
+		inline K w_dist(const Wheel<K>& _wheel)
+		{
+			return _wheel(stream());
+		}
+
+		/// Random index drawn with probability proportional to the weights.
+		/// Used for one-off distributions, which are not worth
+		/// building an alias table for.
 		inline size_t w_dist(const std::vector<real>& _weights)
 		{
-			glock lk(rng.mtx);
-			std::discrete_distribution<size_t> dist(_weights.begin(), _weights.end());
-			return dist(rng.engine);
+			return std::distance(_weights.begin(), w_pick(_weights.begin(), _weights.end(), [](const real _w)
+			{
+				return _w;
+			}));
 		}
 
 		/// Generic random functions
@@ -424,17 +549,50 @@ namespace Cortex
 		template<template <typename ...> class Cont, typename K, typename ... Hash>
 		inline K w_dist(const Cont<K, real, Hash...>& _cont)
 		{
-			std::vector<K> values;
-			std::vector<real> weights;
+			auto it(w_pick(_cont.begin(), _cont.end(), [](const auto& _w)
+			{
+				return _w.second;
+			}));
+			return it->first;
+		}
+
+		/// Pick an element from a range with probability
+		/// proportional to its weight.
+		/// Two linear passes, no allocation.
+		template<typename It, typename W>
+		inline It w_pick(It _begin, It _end, W&& _weight)
+		{
+			real sum(0.0);
+			for (It it = _begin; it != _end; ++it)
+			{
+				sum += _weight(*it);
+			}
 
-			for (const auto& key : _cont)
+			It pick(_begin);
+			if (sum > 0.0)
+			{
+				real u(rnd_real(0.0, sum));
+				for (It it = _begin; it != _end; ++it)
+				{
+					if (_weight(*it) > 0.0)
+					{
+						/// Guard against rounding errors
+						/// by keeping the last positive weight.
+						pick = it;
+						u -= _weight(*it);
+						if (u < 0.0)
+						{
+							break;
+						}
+					}
+				}
+			}
+			else
 			{
-				values.push_back(key.first);
-				weights.push_back(key.second);
+				std::advance(pick, rnd_int<size_t>(0, std::distance(_begin, _end) - 1));
 			}
 
-			size_t u(w_dist(weights));
-			return values[u];
+			return pick;
 		}
 
 	};
@@ -106,4 +106,26 @@ namespace Cortex
 	};
 	template<> Search Enum<Search>::undef = Search::Undef;
 
+	template<> EnumMap<Sched> Enum<Sched>::entries =
+	{
+		{Sched::Fifo, "fifo"},
+		{Sched::LPT, "lpt"},
+		{Sched::Chunked, "chunked"}
+	};
+	template<> Sched Enum<Sched>::undef = Sched::Undef;
+
+	template<> EnumMap<Topology> Enum<Topology>::entries =
+	{
+		{Topology::Ring, "ring"},
+		{Topology::Full, "full"}
+	};
+	template<> Topology Enum<Topology>::undef = Topology::Undef;
+
+	template<> EnumMap<Sim> Enum<Sim>::entries =
+	{
+		{Sim::Event, "event"},
+		{Sim::Clock, "clock"}
+	};
+	template<> Sim Enum<Sim>::undef = Sim::Undef;
+
 }
@@ -3,6 +3,8 @@
 
 #include <unordered_map>
 #include <string>
+#include <array>
+#include <utility>
 
 namespace Cortex
 {
@@ -35,6 +37,11 @@ namespace Cortex
 		R
 	};
 
+	/// Number of valid (non-Undef) values of an enum class
+	template<typename E> struct EnumSize;
+	template<> struct EnumSize<NR> { static constexpr uint value = 4; };
+	template<> struct EnumSize<LT> { static constexpr uint value = 2; };
+
 	/// Function types
 	enum class Fn : uint
 	{
@@ -118,6 +125,14 @@ namespace Cortex
 		ST // Spatiotemporal
 	};
 
+	/// Spiking simulation methods
+	enum class Sim : uint
+	{
+		Undef,
+		Event, // Event-driven (exact spike times)
+		Clock // Clock-driven (fixed time step)
+	};
+
 	/// Search modes
 	enum class Search : uint
 	{
@@ -127,6 +142,23 @@ namespace Cortex
 		Novelty
 	};
 
+	/// Scheduling policies for evaluating networks
+	enum class Sched : uint
+	{
+		Undef,
+		Fifo, // One task per network in storage order
+		LPT, // Longest expected evaluation time first
+		Chunked // LPT with small networks batched together
+	};
+
+	/// Migration topologies for island ecosystems
+	enum class Topology : uint
+	{
+		Undef,
+		Ring, // Each island sends migrants to the next one
+		Full // Each island sends migrants to all others
+	};
+
 	enum class Mark : uint
 	{
 		None,
@@ -149,6 +181,53 @@ namespace Cortex
 
 	template<typename E> using EnumMap = emap<E, std::string>;
 
+	/// Fixed-size table indexed by the valid values
+	/// of an enum class. Unlike an emap, the table
+	/// is stored inline and never allocates.
+	/// Iterating over the table yields key-value pairs.
+	template<typename E, typename T>
+	struct etable
+	{
+		using value_type = std::pair<E, T>;
+
+		std::array<value_type, EnumSize<E>::value> data;
+
+		etable()
+		{
+			for (uint i = 0; i < data.size(); ++i)
+			{
+				data[i].first = static_cast<E>(i + 1);
+			}
+		}
+
+		/// Construct every value with the same arguments
+		template<typename ... Args>
+		explicit etable(const Args& ... _args)
+			:
+			  etable()
+		{
+			for (auto& entry : data)
+			{
+				entry.second = T(_args...);
+			}
+		}
+
+		inline T& at(const E _key)
+		{
+			return data.at(static_cast<uint>(_key) - 1).second;
+		}
+
+		inline const T& at(const E _key) const
+		{
+			return data.at(static_cast<uint>(_key) - 1).second;
+		}
+
+		inline auto begin() { return data.begin(); }
+		inline auto end() { return data.end(); }
+		inline auto begin() const { return data.begin(); }
+		inline auto end() const { return data.end(); }
+	};
+
 	template<typename E>
 	struct Enum
 	{
@@ -227,6 +306,15 @@ namespace Cortex
 
 	template<> EnumMap<Search> Enum<Search>::entries;
 	template<> Search Enum<Search>::undef;
+
+	template<> EnumMap<Sched> Enum<Sched>::entries;
+	template<> Sched Enum<Sched>::undef;
+
+	template<> EnumMap<Topology> Enum<Topology>::entries;
+	template<> Topology Enum<Topology>::undef;
+
+	template<> EnumMap<Sim> Enum<Sim>::entries;
+	template<> Sim Enum<Sim>::undef;
 }
 
 #endif // ENUM_HPP
@@ -10,49 +10,79 @@ namespace Cortex
 		return std::accumulate(_input.begin(), _input.end(), 0.0);
 	}
 
+	inline real Tanh(const real _val)
+	{
+		return std::tanh(_val);
+	}
+
 	inline real Tanh(const std::vector<real>& _input)
 	{
-		return std::tanh( Sum(_input) );
+		return Tanh( Sum(_input) );
+	}
+
+	inline real Sigmoid(const real _val)
+	{
+		return 0.5 * (std::tanh( 0.5 * _val ) + 1.0);
 	}
 
 	inline real Sigmoid(const std::vector<real>& _input)
 	{
-		return 0.5 * (std::tanh( 0.5 * Sum(_input) ) + 1.0);
+		return Sigmoid( Sum(_input) );
 	}
 
 	/// Differentiable and smooth ReLU.
 	/// Goes through the origin.
+	inline real ReLU(const real _val)
+	{
+		const real x4(_val + 4.0);
+		return (0.5 * std::sqrt(x4 * x4 + _val) - 1.0);
+	}
+
 	inline real ReLU(const std::vector<real>& _input)
 	{
-		real x( Sum(_input) );
-		return (0.5 * std::sqrt(std::pow(x + 4.0, 2) + x) - 1.0);
+		return ReLU( Sum(_input) );
 	}
 
-	inline real ReLU(const real _val)
+	inline real Gaussian(const real _val)
 	{
-		return (0.5 * std::sqrt(std::pow(_val + 4.0, 2) + _val) - 1.0);
+		/// Mean = 0, SD = 1, non-normalised
+		return std::exp(-0.5 * _val * _val);
 	}
 
 	inline real Gaussian(const std::vector<real>& _input)
 	{
-		/// Mean = 0, SD = 1, non-normalised
 //			return ( ( std::exp( -( 0.5 * std::pow(Sum(_input), 2) ) ) / std::sqrt(2 * pi) ) );
-		return std::exp(-0.5 * std::pow(Sum(_input), 2));
+		return Gaussian( Sum(_input) );
+	}
+
+	inline real Sin(const real _val)
+	{
+		return std::sin(_val);
 	}
 
 	inline real Sin(const std::vector<real>& _input)
 	{
-		return std::sin( Sum(_input) );
+		return Sin( Sum(_input) );
+	}
+
+	inline real Cos(const real _val)
+	{
+		return std::cos(_val);
 	}
 
 	inline real Cos(const std::vector<real>& _input)
 	{
-		return std::cos( Sum(_input) );
+		return Cos( Sum(_input) );
+	}
+
+	inline real Abs(const real _val)
+	{
+		return std::fabs(_val);
 	}
 
 	inline real Abs(const std::vector<real>& _input)
 	{
-		return std::fabs( Sum(_input) );
+		return Abs( Sum(_input) );
 	}
 
 	inline real Min(const std::vector<real>& _input)
@@ -0,0 +1,90 @@
+#include "GRF.hpp"
+#include "Kernels.hpp"
+
+namespace Cortex
+{
+	void GRF::setup(const std::vector<std::pair<real, real>>& _ranges,
+					const uint _fields,
+					const real _beta)
+	{
+		fields = _fields;
+		mu.clear();
+		scale.clear();
+
+		for (const auto& range : _ranges)
+		{
+			const real span((range.second - range.first) / (_fields - 2.0));
+			const real sigma(span / _beta);
+
+			for (uint i = 1; i <= _fields; ++i)
+			{
+				mu.push_back(range.first + 0.5 * (2.0 * i - 3.0) * span);
+				scale.push_back(1.0 / sigma);
+			}
+		}
+	}
+
+	void GRF::encode(const std::vector<real>& _input,
+					 const uint _samples,
+					 const real _max_latency,
+					 std::vector<real>& _latency) const
+	{
+		const uint var_count(vars());
+		_latency.resize(_samples * mu.size());
+
+		/// Distances from the centres in units of the width
+		real* z(_latency.data());
+		for (uint s = 0; s < _samples; ++s)
+		{
+			const real* x(&_input[s * var_count]);
+			for (uint j = 0; j < mu.size(); ++j)
+			{
+				*z++ = (x[j / fields] - mu[j]) * scale[j];
+			}
+		}
+
+		/// Responses: exp(-0.5 * z^2)
+		Kernels::apply(Fn::Gaussian, _latency.data(), _latency.size());
+
+		/// Stronger responses spike earlier
+		for (real& l : _latency)
+		{
+			l = (1.0 - l) * _max_latency;
+		}
+	}
+
+	GRF::BatchPtr GRF::share(const std::vector<real>& _input,
+							 const uint _samples,
+							 const real _max_latency) const
+	{
+		const uint size(_samples * vars());
+
+		BatchPtr batch;
+		{
+			glock lk(mtx);
+			batch = last;
+		}
+
+		/// Comparing the input is much cheaper than encoding it
+		if (batch &&
+			batch->samples == _samples &&
+			batch->max_latency == _max_latency &&
+			std::equal(batch->input.begin(), batch->input.end(), _input.begin(), _input.begin() + size))
+		{
+			return batch;
+		}
+
+		std::shared_ptr<Batch> encoded(std::make_shared<Batch>());
+		encoded->input.assign(_input.begin(), _input.begin() + size);
+		encoded->samples = _samples;
+		encoded->max_latency = _max_latency;
+		encode(_input, _samples, _max_latency, encoded->latency);
+
+		{
+			glock lk(mtx);
+			last = encoded;
+		}
+
+		return encoded;
+	}
+}
@@ -0,0 +1,121 @@
+#ifndef GRF_HPP
+#define GRF_HPP
+
+#include "Globals.hpp"
+
+namespace Cortex
+{
+	/// \brief Gaussian receptive fields
+	/// (Bohte, Kok & La Poutré, 2002).
+	///
+	/// Each input variable is covered by N overlapping
+	/// Gaussian fields, and each field drives one input node,
+	/// which spikes earlier the closer the variable is to the
+	/// centre of the field.
+	///
+	/// The centres and widths of the fields depend only on
+	/// the input layout, so they are computed once and shared
+	/// by all networks (cf. Config::grf). Whole batches of
+	/// samples are encoded in a single vectorised pass.
+	///
+	/// The last batch encoded with share() is kept, so networks
+	/// evaluated on the same input (e.g., a fixed training set)
+	/// read the same latencies instead of encoding the input
+	/// again, and the cost of encoding does not grow with
+	/// the size of the population.
+	class GRF
+	{
+	public:
+
+		/// An encoded batch
+		struct Batch
+		{
+			/// Row-major (samples x variables) input
+			std::vector<real> input;
+
+			uint samples;
+
+			real max_latency;
+
+			/// Row-major (samples x fields) latencies
+			std::vector<real> latency;
+		};
+
+		using BatchPtr = std::shared_ptr<const Batch>;
+
+	private:
+
+		/// Fields per variable
+		uint fields = 0;
+
+		/// Centre of each field (variable-major)
+		std::vector<real> mu;
+
+		/// 1 / (width of each field),
+		/// so that the response is exp(-0.5 * z^2)
+		/// with z = (x - mu) * scale.
+		std::vector<real> scale;
+
+		/// The last batch encoded with share()
+		mutable BatchPtr last;
+		mutable std::mutex mtx;
+
+	public:
+
+		/// Compute the fields for variables with the given
+		/// ranges (min, max). The spread of each field is
+		/// inversely proportional to _beta. There must be
+		/// at least 3 fields per variable.
+		void setup(const std::vector<std::pair<real, real>>& _ranges,
+				   const uint _fields,
+				   const real _beta);
+
+		/// Discard the fields and the shared batch
+		inline void clear()
+		{
+			fields = 0;
+			mu.clear();
+			scale.clear();
+
+			glock lk(mtx);
+			last.reset();
+		}
+
+		inline bool empty() const
+		{
+			return mu.empty();
+		}
+
+		/// Number of variables
+		inline uint vars() const
+		{
+			return (fields > 0 ? mu.size() / fields : 0);
+		}
+
+		/// Number of fields (input nodes)
+		inline uint size() const
+		{
+			return mu.size();
+		}
+
+		/// Encode a batch of samples into spike latencies
+		/// in [0, _max_latency].
+		/// \param _input Row-major (samples x variables) matrix.
+		/// \param _latency Filled with a row-major
+		/// (samples x fields) matrix.
+		void encode(const std::vector<real>& _input,
+					const uint _samples,
+					const real _max_latency,
+					std::vector<real>& _latency) const;
+
+		/// Encode a batch or, if it is the same as the last
+		/// batch encoded by this function, return that one.
+		/// Thread-safe. The batch stays valid for as long
+		/// as the pointer is held.
+		BatchPtr share(const std::vector<real>& _input,
+					   const uint _samples,
+					   const real _max_latency) const;
+	};
+}
+
+#endif // GRF_HPP
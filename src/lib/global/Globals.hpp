@@ -13,9 +13,12 @@
 #include <algorithm>
 #include <numeric>
 #include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "Enum.hpp"
-#include "threadpool.hpp"
+#include "Arena.hpp"
 #include "dlog.hpp"
 
 namespace Cortex
@@ -33,10 +36,13 @@ namespace Cortex
 	using glock = std::lock_guard<std::mutex>;
 
 	/// Key: spike time
-	/// Value: source - target pair
+	/// Value: node
 	using event = std::pair<real, uint>;
+
+	/// Key: spike arrival time
+	/// Value: source node - outgoing link pair
+	/// (cf. Scheduler and Plan::out)
 	using event_pair = std::pair<real, std::pair<uint, uint>>;
-	using Scheduler = std::priority_queue<event_pair, std::vector<event_pair>, std::greater<event_pair>>;
 
 //	/// The substrate can have any dimensionality.
 //	/// Key: Point (a point in space)
@@ -47,6 +53,9 @@ namespace Cortex
 	template<typename T1, typename T2> using hmap = std::unordered_map<T1, T2>;
 	template<typename T> using hset = std::unordered_set<T>;
 
+	/// Hash map allocating from an arena
+	template<typename T1, typename T2> using amap = std::unordered_map<T1, T2, std::hash<T1>, std::equal_to<T1>, ArenaAllocator<std::pair<const T1, T2>>>;
+
 	class Ecosystem;
 	class Species;
 	class Net;
@@ -58,9 +67,9 @@ namespace Cortex
 	using SpeciesRef = std::reference_wrapper<Species>;
 	using NetRef = std::reference_wrapper<Net>;
 	using NodeRef = std::reference_wrapper<Node>;
-	using NodePtr = std::unique_ptr<Node>;
+	using NodePtr = ArenaPtr<Node>;
 	using LinkRef = std::reference_wrapper<Link>;
-	using LinkPtr = std::unique_ptr<Link>;
+	using LinkPtr = ArenaPtr<Link>;
 	using ParamRef = std::reference_wrapper<Param>;
 
 	/// Some constants.
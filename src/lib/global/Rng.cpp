@@ -0,0 +1,20 @@
+#include "Rng.hpp"
+
+namespace Cortex
+{
+	constexpr uint64_t Rng::gamma;
+
+	thread_local Rng* Rng::current(nullptr);
+
+	Rng::Scope::Scope(Rng& _rng)
+		:
+		  prev(current)
+	{
+		current = &_rng;
+	}
+
+	Rng::Scope::~Scope()
+	{
+		current = prev;
+	}
+}
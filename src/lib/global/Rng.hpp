@@ -0,0 +1,96 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+#include <limits>
+
+namespace Cortex
+{
+	/// \brief Lightweight random number stream.
+	///
+	/// SplitMix64 generator (Steele, Lea and Flood, 2014).
+	/// Each stream is identified by a seed and a stream ID,
+	/// so independent streams can be derived from a single seed
+	/// without any shared state between them.
+	/// The state is a single 64-bit word, which makes it cheap
+	/// to give every network its own stream.
+	///
+	/// Satisfies the UniformRandomBitGenerator requirements
+	/// and can therefore be used with the standard distributions.
+	class Rng
+	{
+	public:
+
+		using result_type = uint64_t;
+
+		explicit Rng(const uint64_t _seed = 0, const uint64_t _stream = 0)
+		{
+			seed(_seed, _stream);
+		}
+
+		inline void seed(const uint64_t _seed, const uint64_t _stream = 0)
+		{
+			state = mix(_seed ^ mix(_stream + gamma));
+		}
+
+		inline result_type operator()()
+		{
+			return mix(state += gamma);
+		}
+
+		static constexpr result_type min()
+		{
+			return std::numeric_limits<result_type>::min();
+		}
+
+		static constexpr result_type max()
+		{
+			return std::numeric_limits<result_type>::max();
+		}
+
+		/// The stream activated in the calling thread
+		/// (nullptr if there is none).
+		static inline Rng* active()
+		{
+			return current;
+		}
+
+		/// Makes a stream the active one in the calling thread
+		/// for the lifetime of the scope.
+		/// Scopes can be nested.
+		class Scope
+		{
+		public:
+
+			explicit Scope(Rng& _rng);
+
+			Scope(const Scope& _other) = delete;
+
+			Scope& operator = (const Scope& _other) = delete;
+
+			~Scope();
+
+		private:
+
+			Rng* prev;
+		};
+
+	private:
+
+		static constexpr uint64_t gamma = 0x9e3779b97f4a7c15ULL;
+
+		uint64_t state;
+
+		/// The active stream of each thread
+		static thread_local Rng* current;
+
+		static inline uint64_t mix(uint64_t _z)
+		{
+			_z = (_z ^ (_z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			_z = (_z ^ (_z >> 27)) * 0x94d049bb133111ebULL;
+			return _z ^ (_z >> 31);
+		}
+	};
+}
+
+#endif // RNG_HPP
@@ -0,0 +1,176 @@
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+#include "Globals.hpp"
+#include "Rng.hpp"
+
+namespace Cortex
+{
+	/// \brief Weighted sampling with the alias method.
+	///
+	/// The table is built in O(n) with Vose's algorithm
+	/// and each sample takes O(1) time and a single draw
+	/// from the random stream, without locking or allocating.
+	/// Entries with a weight of 0 are never sampled.
+	/// If all weights are 0, the entries are sampled uniformly.
+	///
+	/// The weights are kept so that the table can be
+	/// rescaled and rebuilt in place (see scale() and rebuild()).
+	/// Rebuilding a table of the same size does not allocate.
+	template<typename K>
+	class Sampler
+	{
+	private:
+
+		std::vector<K> keys;
+
+		std::vector<real> weights;
+
+		/// Probability of keeping each column
+		std::vector<real> prob;
+
+		/// Alternative for each column
+		std::vector<uint> alias;
+
+		/// Scratch space for rebuilding the table
+		std::vector<uint> small;
+		std::vector<uint> large;
+
+	public:
+
+		Sampler() = default;
+
+		template<typename Cont>
+		explicit Sampler(const Cont& _weights)
+		{
+			build(_weights);
+		}
+
+		/// Build the table from a container
+		/// of (key, weight) pairs.
+		template<typename Cont>
+		inline void build(const Cont& _weights)
+		{
+			keys.clear();
+			weights.clear();
+			for (const auto& w : _weights)
+			{
+				keys.push_back(w.first);
+				weights.push_back(w.second);
+			}
+			rebuild();
+		}
+
+		/// Multiply the weight of a key by a factor.
+		/// The table must be rebuilt afterwards.
+		inline void scale(const K& _key, const real _factor)
+		{
+			for (uint i = 0; i < keys.size(); ++i)
+			{
+				if (keys[i] == _key)
+				{
+					weights[i] *= _factor;
+				}
+			}
+		}
+
+		/// Rebuild the table from the current weights
+		inline void rebuild()
+		{
+			const uint n(keys.size());
+			prob.resize(n);
+			alias.resize(n);
+			small.clear();
+			large.clear();
+
+			const real sum(std::accumulate(weights.begin(), weights.end(), 0.0));
+
+			if (sum <= 0.0)
+			{
+				std::fill(prob.begin(), prob.end(), 1.0);
+				std::iota(alias.begin(), alias.end(), 0);
+				return;
+			}
+
+			for (uint i = 0; i < n; ++i)
+			{
+				prob[i] = weights[i] * n / sum;
+				alias[i] = i;
+				if (prob[i] >= 1.0)
+				{
+					large.push_back(i);
+				}
+				else if (weights[i] > 0.0)
+				{
+					small.push_back(i);
+				}
+			}
+
+			/// Columns with a weight of 0 are paired off first
+			/// so that they cannot be left over because of rounding.
+			for (uint i = 0; i < n; ++i)
+			{
+				if (weights[i] <= 0.0)
+				{
+					prob[i] = 0.0;
+					small.push_back(i);
+				}
+			}
+
+			while (!small.empty() &&
+				   !large.empty())
+			{
+				const uint s(small.back());
+				const uint l(large.back());
+				small.pop_back();
+
+				alias[s] = l;
+				prob[l] -= 1.0 - prob[s];
+
+				if (prob[l] < 1.0)
+				{
+					large.pop_back();
+					small.push_back(l);
+				}
+			}
+
+			/// Anything left over is full up to rounding errors
+			for (const uint l : large)
+			{
+				prob[l] = 1.0;
+			}
+			for (const uint s : small)
+			{
+				if (weights[s] > 0.0)
+				{
+					prob[s] = 1.0;
+				}
+			}
+		}
+
+		inline bool empty() const
+		{
+			return keys.empty();
+		}
+
+		inline uint size() const
+		{
+			return keys.size();
+		}
+
+		/// Draw a key.
+		/// The table must not be empty.
+		inline K operator()(Rng& _rng) const
+		{
+			/// The top 53 bits make up a uniform real number in [0, n).
+			/// Its integral part selects the column and
+			/// its fractional part decides between the column and its alias.
+			const real x((_rng() >> 11) * (1.0 / 9007199254740992.0) * keys.size());
+			const uint col(std::min<uint>(x, keys.size() - 1));
+
+			return (x - col < prob[col]) ? keys[col] : keys[alias[col]];
+		}
+	};
+}
+
+#endif // SAMPLER_HPP
@@ -0,0 +1,145 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include "Globals.hpp"
+
+namespace Cortex
+{
+	/// \brief Calendar queue of spike events.
+	///
+	/// Time is divided into buckets of equal width arranged
+	/// in a ring (Brown, 1988). An event is appended to the
+	/// bucket of its timestamp in O(1) time, and only the
+	/// bucket holding the earliest events is kept sorted.
+	///
+	/// The ring must span the horizon of the simulation,
+	/// i.e., no event may be scheduled further ahead of the
+	/// earliest pending event than the horizon passed to reset().
+	/// Spiking networks satisfy this because input latencies
+	/// and link delays are bounded.
+	class Scheduler
+	{
+	private:
+
+		std::vector<std::vector<event_pair>> buckets;
+
+		real width = 1.0;
+
+		uint mask = 0;
+
+		/// Absolute index of the bucket holding the earliest events
+		ulong slot = 0;
+
+		/// Number of pending events
+		uint count = 0;
+
+		inline ulong slot_of(const real _time) const
+		{
+			return static_cast<ulong>(_time / width);
+		}
+
+		inline std::vector<event_pair>& current()
+		{
+			return buckets[slot & mask];
+		}
+
+		/// The earliest event is kept at the back
+		inline void sort_current()
+		{
+			std::sort(current().begin(), current().end(), std::greater<event_pair>());
+		}
+
+	public:
+
+		/// Discard all events and size the ring so that
+		/// it can hold events up to _horizon ahead.
+		inline void reset(const real _horizon, const real _width)
+		{
+			uint size(1);
+			while (size * _width <= _horizon + _width)
+			{
+				size <<= 1;
+			}
+
+			if (size != buckets.size())
+			{
+				buckets.resize(size);
+			}
+
+			if (count > 0)
+			{
+				for (auto& bucket : buckets)
+				{
+					bucket.clear();
+				}
+			}
+
+			width = _width;
+			mask = size - 1;
+			slot = 0;
+			count = 0;
+		}
+
+		inline bool empty() const
+		{
+			return count == 0;
+		}
+
+		inline uint size() const
+		{
+			return count;
+		}
+
+		inline void push(const event_pair& _event)
+		{
+			const ulong s(slot_of(_event.first));
+			std::vector<event_pair>& bucket(buckets[s & mask]);
+
+			if (count == 0 ||
+				s < slot)
+			{
+				/// The event is the earliest one
+				bucket.push_back(_event);
+				slot = s;
+				sort_current();
+			}
+			else if (s == slot)
+			{
+				bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), _event, std::greater<event_pair>()), _event);
+			}
+			else
+			{
+				bucket.push_back(_event);
+			}
+
+			++count;
+		}
+
+		/// The earliest event.
+		/// The scheduler must not be empty.
+		inline const event_pair& top()
+		{
+			return current().back();
+		}
+
+		inline void pop()
+		{
+			current().pop_back();
+			--count;
+
+			if (count > 0 &&
+				current().empty())
+			{
+				/// Move on to the next occupied bucket
+				do
+				{
+					++slot;
+				} while (current().empty());
+
+				sort_current();
+			}
+		}
+	};
+}
+
+#endif // SCHEDULER_HPP
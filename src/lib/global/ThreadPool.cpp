@@ -0,0 +1,422 @@
+#include "ThreadPool.hpp"
+
+namespace Cortex
+{
+	thread_local ThreadPool* ThreadPool::pool(nullptr);
+	thread_local uint ThreadPool::index(0);
+
+	ThreadPool::Deque::Deque()
+		:
+		  top(0),
+		  bottom(0)
+	{
+		buffers.emplace_back(new Buffer(64));
+		buffer.store(buffers.back().get());
+	}
+
+	void ThreadPool::Deque::push(const Task& _task)
+	{
+		const int64_t b(bottom.load(std::memory_order_relaxed));
+		const int64_t t(top.load(std::memory_order_acquire));
+		Buffer* buf(buffer.load(std::memory_order_relaxed));
+
+		if (b - t > buf->capacity - 1)
+		{
+			/// Grow the buffer
+			buffers.emplace_back(new Buffer(2 * buf->capacity));
+			for (int64_t i = t; i < b; ++i)
+			{
+				buffers.back()->put(i, buf->get(i));
+			}
+			buf = buffers.back().get();
+			buffer.store(buf, std::memory_order_release);
+		}
+
+		buf->put(b, _task);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	bool ThreadPool::Deque::pop(Task& _task)
+	{
+		const int64_t b(bottom.load(std::memory_order_relaxed) - 1);
+		Buffer* buf(buffer.load(std::memory_order_relaxed));
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t(top.load(std::memory_order_relaxed));
+
+		if (t > b)
+		{
+			/// Empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		_task = buf->get(b);
+		if (t == b)
+		{
+			/// Last task: race against the thieves
+			const bool won(top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed));
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+
+		return true;
+	}
+
+	bool ThreadPool::Deque::steal(Task& _task)
+	{
+		int64_t t(top.load(std::memory_order_acquire));
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b(bottom.load(std::memory_order_acquire));
+
+		if (t >= b)
+		{
+			return false;
+		}
+
+		_task = buffer.load(std::memory_order_acquire)->get(t);
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	ThreadPool::Injector::Injector(const uint64_t _capacity)
+		:
+		  capacity(_capacity),
+		  cells(new Cell[_capacity]),
+		  head(0),
+		  tail(0)
+	{
+		for (uint64_t i = 0; i < capacity; ++i)
+		{
+			cells[i].seq.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	bool ThreadPool::Injector::push(const Task& _task)
+	{
+		uint64_t pos(tail.load(std::memory_order_relaxed));
+		while (true)
+		{
+			Cell& cell(cells[pos & (capacity - 1)]);
+			const int64_t diff(int64_t(cell.seq.load(std::memory_order_acquire)) - int64_t(pos));
+
+			if (diff == 0)
+			{
+				/// The cell is free in this lap
+				if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.task = _task;
+					cell.seq.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				/// The cell still holds a task from the previous lap
+				return false;
+			}
+			else
+			{
+				/// Another producer has taken the position
+				pos = tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool ThreadPool::Injector::pop(Task& _task)
+	{
+		uint64_t pos(head.load(std::memory_order_relaxed));
+		while (true)
+		{
+			Cell& cell(cells[pos & (capacity - 1)]);
+			const int64_t diff(int64_t(cell.seq.load(std::memory_order_acquire)) - int64_t(pos + 1));
+
+			if (diff == 0)
+			{
+				/// The cell holds a task for this lap
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					_task = cell.task;
+					cell.seq.store(pos + capacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				/// Nothing has been written yet
+				return false;
+			}
+			else
+			{
+				/// Another consumer has taken the task
+				pos = head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	ThreadPool::ThreadPool(const uint _workers)
+		:
+		  injected(1024),
+		  pending(0),
+		  queued(0),
+		  sleeping(0),
+		  halt(false),
+		  quit(false)
+	{
+		start(_workers);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		stop();
+		wait();
+		shutdown();
+	}
+
+	void ThreadPool::start(const uint _count)
+	{
+		deques.clear();
+		for (uint i = 0; i < std::max<uint>(_count, 1); ++i)
+		{
+			deques.emplace_back(new Deque());
+		}
+
+		for (uint i = 0; i < deques.size(); ++i)
+		{
+			workers.emplace_back(&ThreadPool::work, this, i);
+		}
+	}
+
+	void ThreadPool::shutdown()
+	{
+		{
+			glock lk(mtx);
+			quit.store(true);
+			semaphore.notify_all();
+		}
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		workers.clear();
+		quit.store(false);
+	}
+
+	void ThreadPool::work(const uint _index)
+	{
+		pool = this;
+		index = _index;
+
+		Task task;
+		while (true)
+		{
+			if (find(task))
+			{
+				execute(task);
+				continue;
+			}
+
+			/// Spin for a while before going to sleep
+			bool found(false);
+			for (uint spin = 0; spin < 64 && !found; ++spin)
+			{
+				std::this_thread::yield();
+				found = (queued.load() > 0);
+			}
+
+			if (found)
+			{
+				continue;
+			}
+
+			ulock lk(mtx);
+			sleeping.fetch_add(1);
+			if (queued.load() == 0 &&
+				!quit.load())
+			{
+				semaphore.wait(lk);
+			}
+			sleeping.fetch_sub(1);
+
+			if (quit.load() &&
+				queued.load() == 0)
+			{
+				break;
+			}
+		}
+
+		pool = nullptr;
+	}
+
+	bool ThreadPool::find(Task& _task)
+	{
+		if (pool == this &&
+			deques[index]->pop(_task))
+		{
+			queued.fetch_sub(1);
+			return true;
+		}
+
+		/// Try to steal from the other workers,
+		/// starting with the next one.
+		const uint count(deques.size());
+		const uint first(pool == this ? index + 1 : 0);
+		for (uint i = 0; i < count; ++i)
+		{
+			Deque& victim(*deques[(first + i) % count]);
+			if (&victim != (pool == this ? deques[index].get() : nullptr) &&
+				victim.steal(_task))
+			{
+				queued.fetch_sub(1);
+				return true;
+			}
+		}
+
+		if (injected.pop(_task))
+		{
+			queued.fetch_sub(1);
+			return true;
+		}
+
+		return false;
+	}
+
+	void ThreadPool::execute(const Task& _task)
+	{
+		Job& job(*_task.job);
+		uint end(_task.end);
+
+		/// Once the pool is stopped or the job is cancelled,
+		/// the remaining iterations are only accounted for.
+		if (!halt.load() &&
+			!(job.token && job.token->cancelled()))
+		{
+			/// Keep the lower half and make the upper half
+			/// available for stealing until the grain size is reached
+			while (end - _task.begin > job.grain)
+			{
+				const uint mid(_task.begin + (end - _task.begin) / 2);
+				submit({&job, mid, end});
+				end = mid;
+			}
+
+			job.call(job.body, _task.begin, end);
+		}
+
+		/// The job may be destroyed by its owner
+		/// as soon as the last iteration is accounted for.
+		const uint size(end - _task.begin);
+		const bool job_done(job.left.fetch_sub(size) == size);
+		const bool pool_done(pending.fetch_sub(1) == 1);
+
+		if (job_done || pool_done)
+		{
+			glock lk(mtx);
+			finished.notify_all();
+		}
+	}
+
+	void ThreadPool::submit(const Task& _task)
+	{
+		pending.fetch_add(1);
+
+		/// Counted before it becomes visible
+		/// so that the count never drops below 0
+		queued.fetch_add(1);
+
+		if (pool == this)
+		{
+			deques[index]->push(_task);
+		}
+		else
+		{
+			/// The workers always drain the queue,
+			/// even after stop(), so a full queue
+			/// frees up shortly.
+			while (!injected.push(_task))
+			{
+				notify();
+				std::this_thread::yield();
+			}
+		}
+
+		notify();
+	}
+
+	void ThreadPool::notify()
+	{
+		if (sleeping.load() > 0)
+		{
+			glock lk(mtx);
+			semaphore.notify_one();
+		}
+	}
+
+	void ThreadPool::help(const Job& _job)
+	{
+		Task task;
+		while (_job.left.load() > 0)
+		{
+			if (find(task))
+			{
+				execute(task);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	bool ThreadPool::post(Work& _work, const Token* _token)
+	{
+		if (halt.load())
+		{
+			return false;
+		}
+
+		/// A single iteration which is never split
+		Job& job(_work.job);
+		job.call = &Work::call;
+		job.body = &_work;
+		job.grain = 1;
+		job.token = _token;
+		job.left.store(1);
+
+		submit({&job, 0, 1});
+
+		return true;
+	}
+
+	void ThreadPool::stop()
+	{
+		halt.store(true);
+	}
+
+	void ThreadPool::wait()
+	{
+		if (pool == this)
+		{
+			/// A worker cannot wait for itself
+			return;
+		}
+
+		ulock lk(mtx);
+		finished.wait(lk, [&]{ return pending.load() == 0; });
+	}
+
+	void ThreadPool::resize(const uint _count)
+	{
+		if (halt.load() ||
+			pool == this)
+		{
+			return;
+		}
+
+		wait();
+		shutdown();
+		start(_count);
+	}
+}
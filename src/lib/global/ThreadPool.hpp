@@ -0,0 +1,370 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+
+#include "Globals.hpp"
+
+namespace Cortex
+{
+	/// \brief Flag for cancelling work cooperatively.
+	///
+	/// Long-running tasks should poll it and return early
+	/// once it is set. Tasks of a parallel_for() call with
+	/// a cancelled token which have not started yet are skipped.
+	class Token
+	{
+	private:
+
+		std::atomic<bool> flag;
+
+	public:
+
+		Token()
+			:
+			  flag(false)
+		{}
+
+		inline void cancel()
+		{
+			flag.store(true, std::memory_order_relaxed);
+		}
+
+		inline void reset()
+		{
+			flag.store(false, std::memory_order_relaxed);
+		}
+
+		inline bool cancelled() const
+		{
+			return flag.load(std::memory_order_relaxed);
+		}
+	};
+
+	/// \brief Work-stealing thread pool.
+	///
+	/// Each worker owns a Chase-Lev deque (Chase and Lev, 2005;
+	/// with the memory ordering of Lê et al., 2013).
+	/// The owner pushes and pops tasks at the bottom of its deque
+	/// without locking, while idle workers steal from the top.
+	///
+	/// Work is submitted in bulk with parallel_for(), which
+	/// describes the whole range with a single task. The worker
+	/// which picks it up splits it in halves, keeping one half
+	/// and pushing the other onto its deque, until the chunks
+	/// reach the requested grain size. Thieves therefore always
+	/// take the largest remaining chunks. Submission does not
+	/// allocate: the job descriptor lives on the stack of the
+	/// caller, which blocks until the whole range is processed.
+	///
+	/// parallel_for() can also be called from inside a task,
+	/// in which case the calling worker helps with the
+	/// processing instead of blocking. Tasks submitted from
+	/// outside the pool go through a bounded lock-free queue
+	/// and are started in the order in which they were submitted.
+	///
+	/// Single fire-and-forget tasks are submitted with post().
+	/// They are intrusive (cf. Work), so posting does not allocate
+	/// either, and wait() returns once they have been processed.
+	class ThreadPool
+	{
+	private:
+
+		/// A range of iterations of a parallel_for() call
+		struct Job
+		{
+			/// Calls the loop body for a subrange
+			void (*call)(void* _body, const uint _begin, const uint _end);
+
+			void* body;
+
+			uint grain;
+
+			/// Optional cancellation token
+			const Token* token;
+
+			/// Number of iterations which
+			/// have not been processed yet
+			std::atomic<uint> left;
+		};
+
+		struct Task
+		{
+			Job* job;
+			uint begin;
+			uint end;
+		};
+
+		/// Deque slot. The fields are atomic because
+		/// a thief may read a slot which is being overwritten;
+		/// such a read is discarded when the steal fails.
+		struct Slot
+		{
+			std::atomic<Job*> job;
+			std::atomic<uint64_t> range;
+		};
+
+		struct Buffer
+		{
+			const int64_t capacity;
+			std::unique_ptr<Slot[]> slots;
+
+			explicit Buffer(const int64_t _capacity)
+				:
+				  capacity(_capacity),
+				  slots(new Slot[_capacity])
+			{}
+
+			inline void put(const int64_t _pos, const Task& _task)
+			{
+				Slot& slot(slots[_pos & (capacity - 1)]);
+				slot.job.store(_task.job, std::memory_order_relaxed);
+				slot.range.store((uint64_t(_task.begin) << 32) | _task.end, std::memory_order_relaxed);
+			}
+
+			inline Task get(const int64_t _pos) const
+			{
+				const Slot& slot(slots[_pos & (capacity - 1)]);
+				const uint64_t range(slot.range.load(std::memory_order_relaxed));
+				return {slot.job.load(std::memory_order_relaxed), uint(range >> 32), uint(range)};
+			}
+		};
+
+		/// Chase-Lev deque
+		struct Deque
+		{
+			std::atomic<int64_t> top;
+			std::atomic<int64_t> bottom;
+			std::atomic<Buffer*> buffer;
+
+			/// Buffers replaced by larger ones.
+			/// Thieves may still be reading them,
+			/// so they are released with the deque.
+			std::vector<std::unique_ptr<Buffer>> buffers;
+
+			Deque();
+
+			/// Owner only
+			void push(const Task& _task);
+
+			/// Owner only
+			bool pop(Task& _task);
+
+			/// Any thread
+			bool steal(Task& _task);
+		};
+
+		/// \brief Bounded lock-free FIFO queue for tasks
+		/// submitted by threads outside the pool
+		/// (Vyukov's bounded multi-producer multi-consumer queue).
+		///
+		/// The sequence number of each cell tells producers and
+		/// consumers whether the cell is free or holds a task for
+		/// the current lap of the ring, so any number of threads
+		/// can push and pop at the same time. Tasks are taken
+		/// in the order in which they were queued.
+		struct Injector
+		{
+			struct Cell
+			{
+				std::atomic<uint64_t> seq;
+				Task task;
+			};
+
+			/// Power of 2
+			const uint64_t capacity;
+			std::unique_ptr<Cell[]> cells;
+
+			/// Next position to read
+			std::atomic<uint64_t> head;
+
+			/// Next position to write
+			std::atomic<uint64_t> tail;
+
+			explicit Injector(const uint64_t _capacity);
+
+			/// Returns false if the queue is full
+			bool push(const Task& _task);
+
+			/// Returns false if the queue is empty
+			bool pop(Task& _task);
+		};
+
+		std::vector<std::unique_ptr<Deque>> deques;
+
+		std::vector<std::thread> workers;
+
+		/// Tasks submitted by threads outside the pool
+		Injector injected;
+
+		/// Tasks which are queued or running
+		std::atomic<uint> pending;
+
+		/// Tasks which are queued (used for putting workers to sleep)
+		std::atomic<uint> queued;
+
+		/// Workers waiting for tasks
+		std::atomic<uint> sleeping;
+
+		/// Discard queued tasks and refuse new ones
+		std::atomic<bool> halt;
+
+		/// Shut the workers down
+		std::atomic<bool> quit;
+
+		std::mutex mtx;
+
+		/// Signalled when tasks are available
+		std::condition_variable semaphore;
+
+		/// Signalled when jobs are completed
+		std::condition_variable finished;
+
+		/// The pool and the index of the worker
+		/// running in the current thread, if any
+		static thread_local ThreadPool* pool;
+		static thread_local uint index;
+
+		void start(const uint _count);
+
+		void shutdown();
+
+		void work(const uint _index);
+
+		/// Find a task in the own deque, other deques
+		/// or in the injection queue, in that order.
+		bool find(Task& _task);
+
+		void execute(const Task& _task);
+
+		void submit(const Task& _task);
+
+		/// Wake up a worker if there is any sleeping
+		void notify();
+
+		/// Process tasks until the job is completed
+		void help(const Job& _job);
+
+		template<typename F>
+		static void call(void* _body, const uint _begin, const uint _end)
+		{
+			F& body(*static_cast<F*>(_body));
+			for (uint i = _begin; i < _end; ++i)
+			{
+				body(i);
+			}
+		}
+
+	public:
+
+		/// \brief Fire-and-forget task (cf. post()).
+		///
+		/// Derived classes implement run(). The pool only stores
+		/// a pointer to the task, so it must stay alive until it
+		/// has run (e.g., until wait() returns) and must not be
+		/// posted again before that.
+		class Work
+		{
+		private:
+
+			friend class ThreadPool;
+
+			Job job;
+
+			static void call(void* _work, const uint, const uint)
+			{
+				static_cast<Work*>(_work)->run();
+			}
+
+		public:
+
+			virtual ~Work() = default;
+
+			virtual void run() = 0;
+		};
+
+		explicit ThreadPool(const uint _workers = std::thread::hardware_concurrency());
+
+		ThreadPool(const ThreadPool& _other) = delete;
+
+		ThreadPool& operator = (const ThreadPool& _other) = delete;
+
+		~ThreadPool();
+
+		/// Call _body(i) for every i in [_begin, _end).
+		/// Ranges shorter than _grain iterations are not split further.
+		/// Iterations which have not started by the time
+		/// _token is cancelled are skipped.
+		/// Blocks until all iterations have been processed.
+		/// Returns immediately if the pool has been stopped.
+		template<typename F>
+		void parallel_for(const uint _begin, const uint _end, F&& _body, const uint _grain = 1, const Token* _token = nullptr)
+		{
+			using Body = typename std::remove_reference<F>::type;
+
+			if (_end <= _begin ||
+				halt.load())
+			{
+				return;
+			}
+
+			Job job;
+			job.call = &call<Body>;
+			job.body = const_cast<void*>(static_cast<const void*>(&_body));
+			job.grain = std::max<uint>(_grain, 1);
+			job.token = _token;
+			job.left.store(_end - _begin);
+
+			submit({&job, _begin, _end});
+
+			if (pool == this)
+			{
+				help(job);
+			}
+			else
+			{
+				ulock lk(mtx);
+				finished.wait(lk, [&]{ return job.left.load() == 0; });
+			}
+		}
+
+		/// Queue a task without waiting for it.
+		/// From inside a task, the task is pushed onto the deque
+		/// of the calling worker, otherwise onto the injection queue.
+		/// If the injection queue is full, the caller waits
+		/// until the workers have taken some of the tasks.
+		/// The task is skipped if _token is cancelled before it starts.
+		/// Returns false (and does not queue the task)
+		/// if the pool has been stopped.
+		bool post(Work& _work, const Token* _token = nullptr);
+
+		/// Discard all queued tasks and refuse new ones.
+		/// Tasks which are already running are allowed to finish.
+		void stop();
+
+		/// Wait until all tasks (including posted ones) have been processed.
+		/// Unlike the queued tasks, running tasks
+		/// are waited for even after stop().
+		void wait();
+
+		/// Change the number of workers.
+		/// Waits for all tasks to be processed first,
+		/// so it must not be called from inside a task.
+		/// Not allowed after stop().
+		void resize(const uint _count);
+
+		inline uint worker_count() const
+		{
+			return workers.size();
+		}
+
+		inline bool stopped() const
+		{
+			return halt.load();
+		}
+	};
+}
+
+#endif // THREADPOOL_HPP
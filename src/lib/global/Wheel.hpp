@@ -0,0 +1,216 @@
+#ifndef WHEEL_HPP
+#define WHEEL_HPP
+
+#include "Globals.hpp"
+#include "Rng.hpp"
+
+namespace Cortex
+{
+	/// \brief Roulette wheel which can be updated in place.
+	///
+	/// The weights are kept in a Fenwick tree (Fenwick, 1994),
+	/// so drawing a key, changing its weight, adding a key
+	/// and removing a key all take O(log n) time.
+	/// Unlike Sampler, which is rebuilt from scratch,
+	/// the wheel is meant for populations which change
+	/// between draws (e.g., parents and culling candidates).
+	///
+	/// The keys are stored contiguously (removing a key
+	/// moves the last key into its slot) and can be
+	/// iterated over with begin() and end().
+	template<typename K>
+	class Wheel
+	{
+	private:
+
+		std::vector<K> keys;
+
+		std::vector<real> weights;
+
+		/// Fenwick tree (1-based)
+		std::vector<real> tree;
+
+		/// Key -> slot
+		hmap<K, uint> slots;
+
+		/// Add a value to the weight in a slot (0-based)
+		inline void add(const uint _slot, const real _delta)
+		{
+			for (uint i = _slot + 1; i < tree.size(); i += i & (~i + 1))
+			{
+				tree[i] += _delta;
+			}
+		}
+
+		/// Sum of the weights in slots [0, _count)
+		inline real prefix(uint _count) const
+		{
+			real sum(0.0);
+			for (; _count > 0; _count -= _count & (~_count + 1))
+			{
+				sum += tree[_count];
+			}
+			return sum;
+		}
+
+	public:
+
+		Wheel()
+			:
+			  tree(1, 0.0)
+		{}
+
+		inline void clear()
+		{
+			keys.clear();
+			weights.clear();
+			tree.assign(1, 0.0);
+			slots.clear();
+		}
+
+		inline uint size() const
+		{
+			return keys.size();
+		}
+
+		inline bool empty() const
+		{
+			return keys.empty();
+		}
+
+		inline bool contains(const K& _key) const
+		{
+			return slots.find(_key) != slots.end();
+		}
+
+		inline real weight(const K& _key) const
+		{
+			return weights[slots.at(_key)];
+		}
+
+		/// Sum of all weights
+		inline real total() const
+		{
+			return prefix(keys.size());
+		}
+
+		/// Add a key or change its weight.
+		/// Negative weights are treated as 0.
+		inline void set(const K& _key, real _weight)
+		{
+			_weight = std::max<real>(_weight, 0.0);
+
+			auto it(slots.find(_key));
+			if (it != slots.end())
+			{
+				add(it->second, _weight - weights[it->second]);
+				weights[it->second] = _weight;
+				return;
+			}
+
+			const uint slot(keys.size());
+			slots.emplace(_key, slot);
+			keys.push_back(_key);
+			weights.push_back(_weight);
+
+			/// A new node covers the slots (i - lsb(i), i]
+			const uint i(slot + 1);
+			tree.push_back(_weight + prefix(i - 1) - prefix(i - (i & (~i + 1))));
+		}
+
+		/// Remove a key (if present)
+		inline void erase(const K& _key)
+		{
+			auto it(slots.find(_key));
+			if (it == slots.end())
+			{
+				return;
+			}
+
+			const uint slot(it->second);
+			const uint last(keys.size() - 1);
+			slots.erase(it);
+
+			if (slot != last)
+			{
+				/// Move the last key into the vacated slot
+				add(slot, weights[last] - weights[slot]);
+				weights[slot] = weights[last];
+				keys[slot] = keys[last];
+				slots[keys[slot]] = slot;
+			}
+
+			/// The last node of the tree only covers
+			/// slots up to the last one, so it can be dropped.
+			keys.pop_back();
+			weights.pop_back();
+			tree.pop_back();
+		}
+
+		/// Draw a key with probability proportional to its weight.
+		/// If all weights are 0, the keys are drawn uniformly.
+		/// The wheel must not be empty.
+		inline K operator()(Rng& _rng) const
+		{
+			/// Uniform real number in [0, 1) from the top 53 bits
+			const real u((_rng() >> 11) * (1.0 / 9007199254740992.0));
+
+			const real sum(total());
+			if (sum <= 0.0)
+			{
+				return keys[std::min<uint>(u * keys.size(), keys.size() - 1)];
+			}
+
+			/// Descend the tree to find the first slot
+			/// whose prefix sum exceeds the target.
+			real target(u * sum);
+			uint pos(0);
+			uint step(1);
+			while (2 * step < tree.size())
+			{
+				step *= 2;
+			}
+
+			for (; step > 0; step /= 2)
+			{
+				if (pos + step < tree.size() &&
+					tree[pos + step] <= target)
+				{
+					pos += step;
+					target -= tree[pos];
+				}
+			}
+
+			/// Guard against rounding errors
+			/// by falling back to the closest positive weight.
+			pos = std::min<uint>(pos, keys.size() - 1);
+			for (uint i = pos; i < keys.size(); ++i)
+			{
+				if (weights[i] > 0.0)
+				{
+					return keys[i];
+				}
+			}
+			for (uint i = pos; i > 0; --i)
+			{
+				if (weights[i - 1] > 0.0)
+				{
+					return keys[i - 1];
+				}
+			}
+			return keys[pos];
+		}
+
+		inline auto begin() const
+		{
+			return keys.begin();
+		}
+
+		inline auto end() const
+		{
+			return keys.end();
+		}
+	};
+}
+
+#endif // WHEEL_HPP
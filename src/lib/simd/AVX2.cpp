@@ -0,0 +1,194 @@
+#include "VecMath.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <immintrin.h>
+
+namespace Cortex
+{
+	namespace Kernels
+	{
+		/// Traits for 256-bit vectors (4 x double)
+		struct AVX2
+		{
+			using vec = __m256d;
+			using mask = __m256d;
+
+			static constexpr uint width = 4;
+
+			static inline vec load(const real* _p)
+			{
+				return _mm256_loadu_pd(_p);
+			}
+
+			static inline void store(real* _p, const vec _v)
+			{
+				_mm256_storeu_pd(_p, _v);
+			}
+
+			static inline vec set(const real _v)
+			{
+				return _mm256_set1_pd(_v);
+			}
+
+			static inline vec add(const vec _a, const vec _b)
+			{
+				return _mm256_add_pd(_a, _b);
+			}
+
+			static inline vec sub(const vec _a, const vec _b)
+			{
+				return _mm256_sub_pd(_a, _b);
+			}
+
+			static inline vec mul(const vec _a, const vec _b)
+			{
+				return _mm256_mul_pd(_a, _b);
+			}
+
+			static inline vec div(const vec _a, const vec _b)
+			{
+				return _mm256_div_pd(_a, _b);
+			}
+
+			static inline vec min(const vec _a, const vec _b)
+			{
+				return _mm256_min_pd(_a, _b);
+			}
+
+			static inline vec sqrt(const vec _a)
+			{
+				return _mm256_sqrt_pd(_a);
+			}
+
+			/// a * b + c
+			static inline vec fma(const vec _a, const vec _b, const vec _c)
+			{
+				return _mm256_fmadd_pd(_a, _b, _c);
+			}
+
+			/// c - a * b
+			static inline vec fnma(const vec _a, const vec _b, const vec _c)
+			{
+				return _mm256_fnmadd_pd(_a, _b, _c);
+			}
+
+			static inline vec abs(const vec _a)
+			{
+				return _mm256_andnot_pd(_mm256_set1_pd(-0.0), _a);
+			}
+
+			static inline vec neg(const vec _a)
+			{
+				return _mm256_xor_pd(_a, _mm256_set1_pd(-0.0));
+			}
+
+			static inline vec copysign(const vec _mag, const vec _sgn)
+			{
+				const vec sign(_mm256_set1_pd(-0.0));
+				return _mm256_or_pd(_mm256_andnot_pd(sign, _mag), _mm256_and_pd(sign, _sgn));
+			}
+
+			static inline vec round(const vec _a)
+			{
+				return _mm256_round_pd(_a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			}
+
+			static inline vec floor(const vec _a)
+			{
+				return _mm256_round_pd(_a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+			}
+
+			/// 2^k for integral k in the normal exponent range
+			static inline vec pow2(const vec _k)
+			{
+				const vec magic(_mm256_set1_pd(6755399441055744.0));
+				__m256i k(_mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(_k, magic)), _mm256_castpd_si256(magic)));
+				k = _mm256_slli_epi64(_mm256_add_epi64(k, _mm256_set1_epi64x(1023)), 52);
+				return _mm256_castsi256_pd(k);
+			}
+
+			static inline mask lt(const vec _a, const vec _b)
+			{
+				return _mm256_cmp_pd(_a, _b, _CMP_LT_OQ);
+			}
+
+			static inline mask gt(const vec _a, const vec _b)
+			{
+				return _mm256_cmp_pd(_a, _b, _CMP_GT_OQ);
+			}
+
+			static inline mask eq(const vec _a, const vec _b)
+			{
+				return _mm256_cmp_pd(_a, _b, _CMP_EQ_OQ);
+			}
+
+			/// True if a > b or either is NaN
+			static inline mask not_le(const vec _a, const vec _b)
+			{
+				return _mm256_cmp_pd(_a, _b, _CMP_NLE_UQ);
+			}
+
+			static inline mask mask_or(const mask _a, const mask _b)
+			{
+				return _mm256_or_pd(_a, _b);
+			}
+
+			static inline mask mask_and(const mask _a, const mask _b)
+			{
+				return _mm256_and_pd(_a, _b);
+			}
+
+			static inline bool any(const mask _m)
+			{
+				return _mm256_movemask_pd(_m) != 0;
+			}
+
+			/// m ? a : b
+			static inline vec select(const mask _m, const vec _a, const vec _b)
+			{
+				return _mm256_blendv_pd(_b, _a, _m);
+			}
+		};
+
+		void apply_avx2(const Fn _fn, real* _x, const uint _n)
+		{
+			VecMath<AVX2>::apply(_fn, _x, _n);
+		}
+
+		uint integrate_avx2(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes)
+		{
+			return VecMath<AVX2>::integrate(_al, _decay, _input, _n, _spikes);
+		}
+
+		bool has_avx2()
+		{
+			return true;
+		}
+	}
+}
+
+#else
+
+namespace Cortex
+{
+	namespace Kernels
+	{
+		void apply_avx2(const Fn _fn, real* _x, const uint _n)
+		{
+			apply_scalar(_fn, _x, _n);
+		}
+
+		uint integrate_avx2(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes)
+		{
+			return integrate_scalar(_al, _decay, _input, _n, _spikes);
+		}
+
+		bool has_avx2()
+		{
+			return false;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "VecMath.hpp"
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+namespace Cortex
+{
+	namespace Kernels
+	{
+		/// Traits for 512-bit vectors (8 x double)
+		struct AVX512
+		{
+			using vec = __m512d;
+			using mask = __mmask8;
+
+			static constexpr uint width = 8;
+
+			static inline vec load(const real* _p)
+			{
+				return _mm512_loadu_pd(_p);
+			}
+
+			static inline void store(real* _p, const vec _v)
+			{
+				_mm512_storeu_pd(_p, _v);
+			}
+
+			static inline vec set(const real _v)
+			{
+				return _mm512_set1_pd(_v);
+			}
+
+			static inline vec add(const vec _a, const vec _b)
+			{
+				return _mm512_add_pd(_a, _b);
+			}
+
+			static inline vec sub(const vec _a, const vec _b)
+			{
+				return _mm512_sub_pd(_a, _b);
+			}
+
+			static inline vec mul(const vec _a, const vec _b)
+			{
+				return _mm512_mul_pd(_a, _b);
+			}
+
+			static inline vec div(const vec _a, const vec _b)
+			{
+				return _mm512_div_pd(_a, _b);
+			}
+
+			static inline vec min(const vec _a, const vec _b)
+			{
+				return _mm512_min_pd(_a, _b);
+			}
+
+			static inline vec sqrt(const vec _a)
+			{
+				return _mm512_sqrt_pd(_a);
+			}
+
+			/// a * b + c
+			static inline vec fma(const vec _a, const vec _b, const vec _c)
+			{
+				return _mm512_fmadd_pd(_a, _b, _c);
+			}
+
+			/// c - a * b
+			static inline vec fnma(const vec _a, const vec _b, const vec _c)
+			{
+				return _mm512_fnmadd_pd(_a, _b, _c);
+			}
+
+			static inline vec abs(const vec _a)
+			{
+				return _mm512_abs_pd(_a);
+			}
+
+			/// Bitwise operations on doubles require AVX-512DQ,
+			/// so they are performed on the integer representation.
+			static inline vec neg(const vec _a)
+			{
+				return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_a), _mm512_castpd_si512(_mm512_set1_pd(-0.0))));
+			}
+
+			static inline vec copysign(const vec _mag, const vec _sgn)
+			{
+				const __m512i sign(_mm512_castpd_si512(_mm512_set1_pd(-0.0)));
+				return _mm512_castsi512_pd(_mm512_or_si512(_mm512_andnot_si512(sign, _mm512_castpd_si512(_mag)),
+														   _mm512_and_si512(sign, _mm512_castpd_si512(_sgn))));
+			}
+
+			static inline vec round(const vec _a)
+			{
+				return _mm512_roundscale_pd(_a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			}
+
+			static inline vec floor(const vec _a)
+			{
+				return _mm512_roundscale_pd(_a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+			}
+
+			/// 2^k for integral k in the normal exponent range
+			static inline vec pow2(const vec _k)
+			{
+				const vec magic(_mm512_set1_pd(6755399441055744.0));
+				__m512i k(_mm512_sub_epi64(_mm512_castpd_si512(_mm512_add_pd(_k, magic)), _mm512_castpd_si512(magic)));
+				k = _mm512_slli_epi64(_mm512_add_epi64(k, _mm512_set1_epi64(1023)), 52);
+				return _mm512_castsi512_pd(k);
+			}
+
+			static inline mask lt(const vec _a, const vec _b)
+			{
+				return _mm512_cmp_pd_mask(_a, _b, _CMP_LT_OQ);
+			}
+
+			static inline mask gt(const vec _a, const vec _b)
+			{
+				return _mm512_cmp_pd_mask(_a, _b, _CMP_GT_OQ);
+			}
+
+			static inline mask eq(const vec _a, const vec _b)
+			{
+				return _mm512_cmp_pd_mask(_a, _b, _CMP_EQ_OQ);
+			}
+
+			/// True if a > b or either is NaN
+			static inline mask not_le(const vec _a, const vec _b)
+			{
+				return _mm512_cmp_pd_mask(_a, _b, _CMP_NLE_UQ);
+			}
+
+			static inline mask mask_or(const mask _a, const mask _b)
+			{
+				return static_cast<mask>(_a | _b);
+			}
+
+			static inline mask mask_and(const mask _a, const mask _b)
+			{
+				return static_cast<mask>(_a & _b);
+			}
+
+			static inline bool any(const mask _m)
+			{
+				return _m != 0;
+			}
+
+			/// m ? a : b
+			static inline vec select(const mask _m, const vec _a, const vec _b)
+			{
+				return _mm512_mask_blend_pd(_m, _b, _a);
+			}
+		};
+
+		void apply_avx512(const Fn _fn, real* _x, const uint _n)
+		{
+			VecMath<AVX512>::apply(_fn, _x, _n);
+		}
+
+		uint integrate_avx512(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes)
+		{
+			return VecMath<AVX512>::integrate(_al, _decay, _input, _n, _spikes);
+		}
+
+		bool has_avx512()
+		{
+			return true;
+		}
+	}
+}
+
+#else
+
+namespace Cortex
+{
+	namespace Kernels
+	{
+		void apply_avx512(const Fn _fn, real* _x, const uint _n)
+		{
+			apply_scalar(_fn, _x, _n);
+		}
+
+		uint integrate_avx512(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes)
+		{
+			return integrate_scalar(_al, _decay, _input, _n, _spikes);
+		}
+
+		bool has_avx512()
+		{
+			return false;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include "Kernels.hpp"
+#include "Functions.hpp"
+
+namespace Cortex
+{
+	namespace Kernels
+	{
+		static ISA detect()
+		{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			__builtin_cpu_init();
+
+			if (has_avx512() &&
+				__builtin_cpu_supports("avx512f"))
+			{
+				return ISA::AVX512;
+			}
+
+			if (has_avx2() &&
+				__builtin_cpu_supports("avx2") &&
+				__builtin_cpu_supports("fma"))
+			{
+				return ISA::AVX2;
+			}
+#endif
+			return ISA::Scalar;
+		}
+
+		ISA isa()
+		{
+			static const ISA selected(detect());
+			return selected;
+		}
+
+		void apply(const Fn _fn, real* _x, const uint _n)
+		{
+			switch (isa())
+			{
+			case ISA::AVX512:
+				apply_avx512(_fn, _x, _n);
+				break;
+
+			case ISA::AVX2:
+				apply_avx2(_fn, _x, _n);
+				break;
+
+			default:
+				apply_scalar(_fn, _x, _n);
+			}
+		}
+
+		uint integrate(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes)
+		{
+			switch (isa())
+			{
+			case ISA::AVX512:
+				return integrate_avx512(_al, _decay, _input, _n, _spikes);
+
+			case ISA::AVX2:
+				return integrate_avx2(_al, _decay, _input, _n, _spikes);
+
+			default:
+				return integrate_scalar(_al, _decay, _input, _n, _spikes);
+			}
+		}
+
+		uint integrate_scalar(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes)
+		{
+			uint count(0);
+			for (uint i = 0; i < _n; ++i)
+			{
+				_al[i] = _al[i] * _decay[i] + _input[i];
+				_input[i] = 0.0;
+				if (_al[i] >= 1.0)
+				{
+					_al[i] = 0.0;
+					_spikes[count++] = i;
+				}
+			}
+			return count;
+		}
+
+		template<typename F>
+		static inline void map(real* _x, const uint _n, F&& _f)
+		{
+			for (uint i = 0; i < _n; ++i)
+			{
+				_x[i] = _f(_x[i]);
+			}
+		}
+
+		void apply_scalar(const Fn _fn, real* _x, const uint _n)
+		{
+			switch (_fn)
+			{
+			case Fn::Sum:
+			case Fn::Min:
+			case Fn::Max:
+			case Fn::Avg:
+				break;
+
+			case Fn::Tanh:
+				map(_x, _n, [](const real _v) { return Tanh(_v); });
+				break;
+
+			case Fn::Logistic:
+				map(_x, _n, [](const real _v) { return Sigmoid(_v); });
+				break;
+
+			case Fn::ReLU:
+				map(_x, _n, [](const real _v) { return ReLU(_v); });
+				break;
+
+			case Fn::Gaussian:
+				map(_x, _n, [](const real _v) { return Gaussian(_v); });
+				break;
+
+			case Fn::Sin:
+				map(_x, _n, [](const real _v) { return Sin(_v); });
+				break;
+
+			case Fn::Cos:
+				map(_x, _n, [](const real _v) { return Cos(_v); });
+				break;
+
+			case Fn::Abs:
+				map(_x, _n, [](const real _v) { return Abs(_v); });
+				break;
+
+			case Fn::Const:
+				std::fill(_x, _x + _n, 1.0);
+				break;
+
+			case Fn::Golden:
+				std::fill(_x, _x + _n, phi);
+				break;
+
+			default:
+				std::fill(_x, _x + _n, 0.0);
+			}
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include "Globals.hpp"
+
+namespace Cortex
+{
+	/// \brief Transfer functions applied to contiguous arrays.
+	///
+	/// Each kernel replaces an array of input sums with the
+	/// output of the transfer function. The instruction set
+	/// is selected once at runtime by CPU detection
+	/// (AVX-512 > AVX2 > scalar).
+	///
+	/// The scalar kernels call the functions in Functions.hpp
+	/// and serve as the reference. Maximal errors of the
+	/// vector kernels relative to the reference, measured in
+	/// units in the last place (ULP) of the reference result:
+	///
+	/// Fn       | Max. error
+	/// ---------|---------------------------------------------
+	/// Sum      | 0 ULP (identity)
+	/// Abs      | 0 ULP
+	/// ReLU     | 0 ULP (same sequence of IEEE operations)
+	/// Tanh     | 3 ULP
+	/// Gaussian | 1 ULP
+	/// Sin      | 1 ULP
+	/// Cos      | 1 ULP
+	/// Logistic | 2 ULP for x >= 0; 2^-53 absolute for x < 0,
+	///          | where the reference itself loses precision
+	///          | in 1 + tanh(x / 2)
+	/// Const    | 0 ULP
+	/// Golden   | 0 ULP
+	///
+	/// Inputs for which the vector kernels cannot guarantee
+	/// these bounds (NaN, |x| > 1e5 for Sin and Cos,
+	/// |x| > 37 for Gaussian, arguments very close to a
+	/// multiple of pi / 2) are passed to the scalar kernels.
+	///
+	/// Min, Max and Avg depend on the individual inputs
+	/// rather than on their sum, so they are not handled here.
+	namespace Kernels
+	{
+		/// Instruction sets
+		enum class ISA : uint
+		{
+			Scalar,
+			AVX2,
+			AVX512
+		};
+
+		/// The instruction set selected by CPU detection
+		ISA isa();
+
+		/// Apply the transfer function _fn
+		/// in place to _n contiguous values.
+		void apply(const Fn _fn, real* _x, const uint _n);
+
+		/// Implementations for specific instruction sets.
+		/// The vector versions forward to the scalar one
+		/// if the library was built without support for them.
+		void apply_scalar(const Fn _fn, real* _x, const uint _n);
+		void apply_avx2(const Fn _fn, real* _x, const uint _n);
+		void apply_avx512(const Fn _fn, real* _x, const uint _n);
+
+		/// One time step of leaky integration for spiking nodes:
+		/// _al[i] = _al[i] * _decay[i] + _input[i].
+		/// The input is cleared afterwards. Nodes whose activation
+		/// reaches the threshold (1) are reset to 0 and their
+		/// indices are written to _spikes in ascending order.
+		/// Returns the number of spikes.
+		/// All versions produce identical results.
+		uint integrate(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes);
+
+		uint integrate_scalar(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes);
+		uint integrate_avx2(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes);
+		uint integrate_avx512(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes);
+
+		/// Indicate whether the vector versions were compiled in
+		bool has_avx2();
+		bool has_avx512();
+	}
+}
+
+#endif // KERNELS_HPP
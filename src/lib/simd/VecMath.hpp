@@ -0,0 +1,340 @@
+#ifndef VECMATH_HPP
+#define VECMATH_HPP
+
+#include "Kernels.hpp"
+
+namespace Cortex
+{
+	namespace Kernels
+	{
+		/// \brief Vectorised transfer functions.
+		///
+		/// The kernels are written once against a set of
+		/// traits (V) wrapping the intrinsics of a particular
+		/// instruction set. This header should only be included
+		/// by the translation units which are compiled
+		/// for that instruction set (AVX2.cpp, AVX512.cpp).
+		///
+		/// Polynomial kernels for sin and cos are from fdlibm.
+		template<typename V>
+		struct VecMath
+		{
+			using vec = typename V::vec;
+			using mask = typename V::mask;
+
+			/// exp(r) - 1 for |r| <= ln(2) / 2.
+			/// Taylor series up to r^13 / 13!
+			/// (truncation error < 0.05 ULP).
+			static inline vec expm1_r(const vec _r)
+			{
+				vec p(V::set(1.0 / 6227020800.0));
+				p = V::fma(p, _r, V::set(1.0 / 479001600.0));
+				p = V::fma(p, _r, V::set(1.0 / 39916800.0));
+				p = V::fma(p, _r, V::set(1.0 / 3628800.0));
+				p = V::fma(p, _r, V::set(1.0 / 362880.0));
+				p = V::fma(p, _r, V::set(1.0 / 40320.0));
+				p = V::fma(p, _r, V::set(1.0 / 5040.0));
+				p = V::fma(p, _r, V::set(1.0 / 720.0));
+				p = V::fma(p, _r, V::set(1.0 / 120.0));
+				p = V::fma(p, _r, V::set(1.0 / 24.0));
+				p = V::fma(p, _r, V::set(1.0 / 6.0));
+				p = V::fma(p, _r, V::set(0.5));
+				return V::fma(V::mul(_r, _r), p, _r);
+			}
+
+			/// Split _x into k * ln(2) + r.
+			/// Returns 2^k and stores r in _r.
+			static inline vec reduce_ln2(const vec _x, vec& _r)
+			{
+				const vec k(V::round(V::mul(_x, V::set(1.44269504088896338700e+00))));
+				_r = V::fnma(k, V::set(6.93147180369123816490e-01), _x);
+				_r = V::fnma(k, V::set(1.90821492927058770002e-10), _r);
+				return V::pow2(k);
+			}
+
+			/// exp(x) for |x| <= 708
+			static inline vec exp(const vec _x)
+			{
+				vec r;
+				const vec s(reduce_ln2(_x, r));
+				return V::fma(s, expm1_r(r), s);
+			}
+
+			/// exp(x) - 1 for 0 <= x <= 708
+			static inline vec expm1(const vec _x)
+			{
+				vec r;
+				const vec s(reduce_ln2(_x, r));
+				return V::fma(s, expm1_r(r), V::sub(s, V::set(1.0)));
+			}
+
+			/// tanh(x) = expm1(2|x|) / (expm1(2|x|) + 2),
+			/// with the sign of x.
+			/// tanh(x) rounds to 1 for |x| > 19.1.
+			static inline vec tanh(const vec _x)
+			{
+				const vec a(V::abs(_x));
+				const vec lim(V::set(20.0));
+				const vec e(expm1(V::mul(V::set(2.0), V::min(a, lim))));
+
+				/// The rounding error of the denominator (TwoSum)
+				/// and the remainder of the division (FMA) are used
+				/// to correct the quotient, so the result is
+				/// nearly as accurate as expm1().
+				const vec two(V::set(2.0));
+				const vec d(V::add(e, two));
+				const vec dd(V::sub(d, e));
+				const vec err(V::add(V::sub(e, V::sub(d, dd)), V::sub(two, dd)));
+				const vec q(V::div(e, d));
+				const vec rem(V::fnma(q, d, e));
+				vec t(V::add(q, V::div(V::fnma(q, err, rem), d)));
+
+				t = V::select(V::gt(a, lim), V::set(1.0), t);
+				return V::copysign(t, _x);
+			}
+
+			/// Reduce _x to y0 + y1 in [-pi/4, pi/4] and return
+			/// the number of quarter periods n (x = n * pi/2 + y).
+			/// pi/2 is split into three parts (fdlibm), which
+			/// makes the products n * p1 and n * p2 exact
+			/// for |n| < 2^20.
+			static inline vec reduce_pio2(const vec _x, vec& _y0, vec& _y1)
+			{
+				const vec n(V::round(V::mul(_x, V::set(6.36619772367581382433e-01))));
+				const vec t(V::fnma(n, V::set(1.57079632673412561417e+00), _x));
+				const vec w(V::mul(n, V::set(6.07710050630396597660e-11)));
+				const vec r(V::sub(t, w));
+				vec lo(V::sub(V::sub(t, r), w));
+				lo = V::fnma(n, V::set(2.02226624879595063154e-21), lo);
+
+				_y0 = V::add(r, lo);
+				_y1 = V::add(V::sub(r, _y0), lo);
+
+				/// No reduction necessary
+				const mask zero(V::eq(n, V::set(0.0)));
+				_y0 = V::select(zero, _x, _y0);
+				_y1 = V::select(zero, V::set(0.0), _y1);
+
+				return n;
+			}
+
+			/// sin(y0 + y1) for |y0 + y1| <= pi/4 (fdlibm __kernel_sin)
+			static inline vec ksin(const vec _y0, const vec _y1)
+			{
+				const vec z(V::mul(_y0, _y0));
+				const vec v(V::mul(z, _y0));
+				vec r(V::set(1.58969099521155010221e-10));
+				r = V::fma(r, z, V::set(-2.50507602534068634195e-08));
+				r = V::fma(r, z, V::set(2.75573137070700676789e-06));
+				r = V::fma(r, z, V::set(-1.98412698298579493134e-04));
+				r = V::fma(r, z, V::set(8.33333333332248946124e-03));
+
+				/// y0 - ((z * (y1 / 2 - v * r) - y1) - v * S1)
+				const vec a(V::fnma(v, r, V::mul(V::set(0.5), _y1)));
+				const vec b(V::sub(V::mul(z, a), _y1));
+				const vec c(V::fnma(v, V::set(-1.66666666666666324348e-01), b));
+				return V::sub(_y0, c);
+			}
+
+			/// cos(y0 + y1) for |y0 + y1| <= pi/4 (fdlibm __kernel_cos)
+			static inline vec kcos(const vec _y0, const vec _y1)
+			{
+				const vec z(V::mul(_y0, _y0));
+				vec r(V::set(-1.13596475577881948265e-11));
+				r = V::fma(r, z, V::set(2.08757232129817482790e-09));
+				r = V::fma(r, z, V::set(-2.75573143513906633035e-07));
+				r = V::fma(r, z, V::set(2.48015872894767294178e-05));
+				r = V::fma(r, z, V::set(-1.38888888888741095749e-03));
+				r = V::fma(r, z, V::set(4.16666666666666019037e-02));
+				r = V::mul(z, r);
+
+				/// w + (((1 - w) - hz) + (z * r - y0 * y1))
+				const vec hz(V::mul(V::set(0.5), z));
+				const vec w(V::sub(V::set(1.0), hz));
+				const vec c(V::sub(V::sub(V::set(1.0), w), hz));
+				const vec d(V::fnma(_y0, _y1, V::mul(z, r)));
+				return V::add(w, V::add(c, d));
+			}
+
+			/// sin(x) if _cos is false, cos(x) otherwise.
+			/// Returns false if any lane is out of range
+			/// or too close to a multiple of pi/2.
+			static inline bool sincos(const vec _x, const bool _cos, vec& _res)
+			{
+				if (V::any(V::not_le(V::abs(_x), V::set(1e5))))
+				{
+					return false;
+				}
+
+				vec y0;
+				vec y1;
+				const vec n(reduce_pio2(_x, y0, y1));
+
+				/// The reduction loses accuracy if the
+				/// argument is close to a multiple of pi/2.
+				if (V::any(V::mask_and(V::lt(V::abs(y0), V::set(9.3132257461547852e-10)),
+									   V::gt(V::abs(n), V::set(0.0)))))
+				{
+					return false;
+				}
+
+				/// Quadrant (n mod 4)
+				const vec q(V::sub(n, V::mul(V::set(4.0), V::floor(V::mul(n, V::set(0.25))))));
+				const mask odd(V::mask_or(V::eq(q, V::set(1.0)), V::eq(q, V::set(3.0))));
+				const mask neg(_cos
+							   ? V::mask_or(V::eq(q, V::set(1.0)), V::eq(q, V::set(2.0)))
+							   : V::gt(q, V::set(1.5)));
+
+				const vec s(ksin(y0, y1));
+				const vec c(kcos(y0, y1));
+
+				_res = (_cos ? V::select(odd, s, c) : V::select(odd, c, s));
+				_res = V::select(neg, V::neg(_res), _res);
+				return true;
+			}
+
+			/// Apply a vector kernel to an array.
+			/// Chunks containing a lane which the kernel cannot
+			/// handle, as well as the tail of the array,
+			/// are passed to the scalar kernel.
+			template<typename K>
+			static inline void map(const Fn _fn, real* _x, const uint _n, K&& _kernel)
+			{
+				uint i(0);
+				vec y;
+				for (; i + V::width <= _n; i += V::width)
+				{
+					if (_kernel(V::load(_x + i), y))
+					{
+						V::store(_x + i, y);
+					}
+					else
+					{
+						apply_scalar(_fn, _x + i, V::width);
+					}
+				}
+
+				if (i < _n)
+				{
+					apply_scalar(_fn, _x + i, _n - i);
+				}
+			}
+
+			/// Leaky integration (cf. Kernels::integrate()).
+			/// No fused operations in order to match
+			/// the scalar version exactly.
+			static uint integrate(real* _al, const real* _decay, real* _input, const uint _n, uint* _spikes)
+			{
+				uint count(0);
+				uint i(0);
+				for (; i + V::width <= _n; i += V::width)
+				{
+					const vec al(V::add(V::mul(V::load(_al + i), V::load(_decay + i)), V::load(_input + i)));
+					V::store(_al + i, al);
+					V::store(_input + i, V::set(0.0));
+
+					/// Spikes are rare, so the lanes are
+					/// only inspected if one of them has spiked.
+					if (V::any(V::mask_or(V::gt(al, V::set(1.0)), V::eq(al, V::set(1.0)))))
+					{
+						for (uint j = i; j < i + V::width; ++j)
+						{
+							if (_al[j] >= 1.0)
+							{
+								_al[j] = 0.0;
+								_spikes[count++] = j;
+							}
+						}
+					}
+				}
+
+				if (i < _n)
+				{
+					const uint tail(integrate_scalar(_al + i, _decay + i, _input + i, _n - i, _spikes + count));
+					for (uint j = count; j < count + tail; ++j)
+					{
+						_spikes[j] += i;
+					}
+					count += tail;
+				}
+
+				return count;
+			}
+
+			static void apply(const Fn _fn, real* _x, const uint _n)
+			{
+				switch (_fn)
+				{
+				case Fn::Tanh:
+					map(_fn, _x, _n, [](const vec _v, vec& _res)
+					{
+						_res = tanh(_v);
+						return !V::any(V::not_le(V::abs(_v), V::set(INFINITY)));
+					});
+					break;
+
+				case Fn::Logistic:
+					map(_fn, _x, _n, [](const vec _v, vec& _res)
+					{
+						/// 0.5 * (tanh(0.5 * x) + 1)
+						_res = V::mul(V::set(0.5), V::add(tanh(V::mul(V::set(0.5), _v)), V::set(1.0)));
+						return !V::any(V::not_le(V::abs(_v), V::set(INFINITY)));
+					});
+					break;
+
+				case Fn::ReLU:
+					map(_fn, _x, _n, [](const vec _v, vec& _res)
+					{
+						/// 0.5 * sqrt((x + 4)^2 + x) - 1.
+						/// No fused operations in order to
+						/// match the scalar version exactly.
+						const vec s(V::add(_v, V::set(4.0)));
+						_res = V::sub(V::mul(V::set(0.5), V::sqrt(V::add(V::mul(s, s), _v))), V::set(1.0));
+						return true;
+					});
+					break;
+
+				case Fn::Gaussian:
+					map(_fn, _x, _n, [](const vec _v, vec& _res)
+					{
+						/// exp(-0.5 * x^2)
+						if (V::any(V::not_le(V::abs(_v), V::set(37.0))))
+						{
+							return false;
+						}
+						_res = exp(V::mul(V::mul(V::set(-0.5), _v), _v));
+						return true;
+					});
+					break;
+
+				case Fn::Sin:
+					map(_fn, _x, _n, [](const vec _v, vec& _res)
+					{
+						return sincos(_v, false, _res);
+					});
+					break;
+
+				case Fn::Cos:
+					map(_fn, _x, _n, [](const vec _v, vec& _res)
+					{
+						return sincos(_v, true, _res);
+					});
+					break;
+
+				case Fn::Abs:
+					map(_fn, _x, _n, [](const vec _v, vec& _res)
+					{
+						_res = V::abs(_v);
+						return true;
+					});
+					break;
+
+				default:
+					apply_scalar(_fn, _x, _n);
+				}
+			}
+		};
+	}
+}
+
+#endif // VECMATH_HPP
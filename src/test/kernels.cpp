@@ -0,0 +1,409 @@
+/// Checks the vector kernels against the scalar reference
+/// and the reference against Functions.hpp, using the error
+/// bounds documented in Kernels.hpp. The integration kernels
+/// must match the scalar version exactly.
+
+#include "Kernels.hpp"
+#include "Functions.hpp"
+#include <cfloat>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+
+using namespace Cortex;
+
+/// Map a double to an integer such that adjacent
+/// doubles map to adjacent integers (+0 and -0 coincide).
+static int64_t ordinal(const real _x)
+{
+	int64_t i;
+	std::memcpy(&i, &_x, sizeof(i));
+	return (i < 0 ? INT64_MIN - i : i);
+}
+
+/// Distance in units in the last place.
+/// Two NaNs are equal, and a NaN is infinitely far from a number.
+static real ulp(const real _ref, const real _val)
+{
+	if (std::isnan(_ref) || std::isnan(_val))
+	{
+		return (std::isnan(_ref) && std::isnan(_val) ? 0.0 : INFINITY);
+	}
+	return std::fabs(static_cast<real>(ordinal(_ref) - ordinal(_val)));
+}
+
+/// Maximal error of a vector kernel relative to the reference
+struct Bound
+{
+	real ulp;
+
+	/// Absolute error allowed for x < 0 (Logistic only)
+	real neg_abs;
+};
+
+static const emap<Fn, Bound> bounds
+{
+	{Fn::Sum, {0.0, -1.0}},
+	{Fn::Abs, {0.0, -1.0}},
+	{Fn::ReLU, {0.0, -1.0}},
+	{Fn::Tanh, {3.0, -1.0}},
+	{Fn::Gaussian, {1.0, -1.0}},
+	{Fn::Sin, {1.0, -1.0}},
+	{Fn::Cos, {1.0, -1.0}},
+	{Fn::Logistic, {2.0, std::ldexp(1.0, -53)}},
+	{Fn::Const, {0.0, -1.0}},
+	{Fn::Golden, {0.0, -1.0}}
+};
+
+/// The scalar reference for a single value
+static real reference(const Fn _fn, const real _x)
+{
+	switch (_fn)
+	{
+	case Fn::Sum:
+		return _x;
+
+	case Fn::Tanh:
+		return Tanh(_x);
+
+	case Fn::Logistic:
+		return Sigmoid(_x);
+
+	case Fn::ReLU:
+		return ReLU(_x);
+
+	case Fn::Gaussian:
+		return Gaussian(_x);
+
+	case Fn::Sin:
+		return Sin(_x);
+
+	case Fn::Cos:
+		return Cos(_x);
+
+	case Fn::Abs:
+		return Abs(_x);
+
+	case Fn::Const:
+		return 1.0;
+
+	case Fn::Golden:
+		return phi;
+
+	default:
+		return 0.0;
+	}
+}
+
+/// Test inputs: uniform samples over ranges of increasing
+/// magnitude plus special values (signed zeros, denormals,
+/// extremes and non-finite values). The lengths are not
+/// multiples of the vector width, so the tails are covered too.
+static std::vector<real> inputs()
+{
+	std::vector<real> x
+	{
+		0.0, -0.0,
+		DBL_MIN, -DBL_MIN,
+		std::numeric_limits<real>::denorm_min(), -std::numeric_limits<real>::denorm_min(),
+		1e-310, -1e-310,
+		DBL_MAX, -DBL_MAX,
+		1e300, -1e300,
+		INFINITY, -INFINITY,
+		NAN, -NAN,
+		18.0, -18.0, 19.0, -19.0,
+		36.9, -36.9, 37.0, -37.0, 37.1, -37.1,
+		1e5, -1e5, 1.00001e5, -1.00001e5,
+		pi / 2.0, -pi / 2.0, pi, -pi,
+		710.0, -710.0, 745.0, -745.0, 746.0, -746.0
+	};
+
+	std::mt19937_64 rng(42);
+	for (const real range : {1e-300, 1e-6, 1.0, 5.0, 40.0, 800.0, 1e4, 2e5, 1e10})
+	{
+		std::uniform_real_distribution<real> dist(-range, range);
+		for (uint i = 0; i < 20011; ++i)
+		{
+			x.push_back(dist(rng));
+		}
+	}
+
+	return x;
+}
+
+/// Compare one kernel with the scalar reference.
+/// Returns the number of violations of the bounds.
+static uint check(const std::string& _name,
+				  void (*_kernel)(const Fn, real*, const uint),
+				  const Fn _fn,
+				  const std::vector<real>& _x)
+{
+	std::vector<real> ref(_x);
+	std::vector<real> val(_x);
+	Kernels::apply_scalar(_fn, ref.data(), ref.size());
+	_kernel(_fn, val.data(), val.size());
+
+	const Bound& bound(bounds.at(_fn));
+
+	uint failures(0);
+	real worst(0.0);
+	for (uint i = 0; i < _x.size(); ++i)
+	{
+		real err(0.0);
+		bool ok(true);
+
+		if (bound.neg_abs >= 0.0 &&
+			_x[i] < 0.0)
+		{
+			err = std::fabs(ref[i] - val[i]);
+			ok = (err <= bound.neg_abs ||
+				  (std::isnan(ref[i]) && std::isnan(val[i])));
+		}
+		else
+		{
+			err = ulp(ref[i], val[i]);
+			ok = (err <= bound.ulp);
+			worst = std::max(worst, err);
+		}
+
+		if (!ok)
+		{
+			if (failures < 5)
+			{
+				std::cout << "\t" << _name << " " << as_str(_fn)
+						  << ": x = " << _x[i]
+						  << ", reference = " << ref[i]
+						  << ", kernel = " << val[i]
+						  << ", error = " << err << "\n";
+			}
+			++failures;
+		}
+	}
+
+	std::cout << _name << " " << as_str(_fn)
+			  << ": max. error " << worst << " ULP (bound " << bound.ulp << ")"
+			  << (failures > 0 ? " FAILED" : "") << std::endl;
+
+	return failures;
+}
+
+/// Leaky integration state for one test case
+struct State
+{
+	std::vector<real> al;
+	std::vector<real> decay;
+	std::vector<real> input;
+};
+
+/// Random states of _n nodes. Some nodes reach
+/// the threshold exactly or land right next to it.
+static State state(const uint _n, std::mt19937_64& _rng)
+{
+	std::uniform_real_distribution<real> al(-0.5, 1.0);
+	std::uniform_real_distribution<real> decay(0.0, 1.0);
+	std::uniform_real_distribution<real> input(-0.5, 1.0);
+	std::uniform_int_distribution<uint> pick(0, 7);
+
+	State st;
+	for (uint i = 0; i < _n; ++i)
+	{
+		st.al.push_back(al(_rng));
+		st.decay.push_back(decay(_rng));
+		st.input.push_back(input(_rng));
+
+		switch (pick(_rng))
+		{
+		case 0:
+			/// 0 * d + 1
+			st.al[i] = 0.0;
+			st.input[i] = 1.0;
+			break;
+
+		case 1:
+			/// 1 * 1 + 0
+			st.al[i] = 1.0;
+			st.decay[i] = 1.0;
+			st.input[i] = 0.0;
+			break;
+
+		case 2:
+			/// 0.5 * 1 + 0.5
+			st.al[i] = 0.5;
+			st.decay[i] = 1.0;
+			st.input[i] = 0.5;
+			break;
+
+		case 3:
+			/// Just below or above the threshold
+			st.al[i] = 0.0;
+			st.input[i] = std::nextafter(1.0, (i % 2 == 0 ? 0.0 : 2.0));
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	return st;
+}
+
+/// Compare one integration kernel with the scalar version.
+/// The activations must be bitwise identical, the input
+/// must be cleared and the spikes must be identical and
+/// in ascending order. Returns the number of mismatches.
+static uint check(const std::string& _name,
+				  uint (*_kernel)(real*, const real*, real*, const uint, uint*),
+				  const uint _n,
+				  const State& _st)
+{
+	State ref(_st);
+	State val(_st);
+	std::vector<uint> ref_spikes(_n);
+	std::vector<uint> val_spikes(_n);
+
+	const uint ref_count(Kernels::integrate_scalar(ref.al.data(), ref.decay.data(), ref.input.data(), _n, ref_spikes.data()));
+	const uint val_count(_kernel(val.al.data(), val.decay.data(), val.input.data(), _n, val_spikes.data()));
+
+	uint failures(0);
+
+	if (_n > 0 &&
+		std::memcmp(ref.al.data(), val.al.data(), _n * sizeof(real)) != 0)
+	{
+		std::cout << "	" << _name << " integrate (n = " << _n << "): activations differ\n";
+		++failures;
+	}
+
+	for (uint i = 0; i < _n; ++i)
+	{
+		if (val.input[i] != 0.0 ||
+			std::signbit(val.input[i]))
+		{
+			std::cout << "	" << _name << " integrate (n = " << _n << "): input " << i << " not cleared\n";
+			++failures;
+			break;
+		}
+	}
+
+	if (ref_count != val_count ||
+		!std::equal(ref_spikes.begin(), ref_spikes.begin() + ref_count, val_spikes.begin()))
+	{
+		std::cout << "	" << _name << " integrate (n = " << _n << "): spikes differ ("
+				  << val_count << " vs. " << ref_count << ")\n";
+		++failures;
+	}
+
+	for (uint s = 1; s < val_count; ++s)
+	{
+		if (val_spikes[s] <= val_spikes[s - 1])
+		{
+			std::cout << "	" << _name << " integrate (n = " << _n << "): spikes not in ascending order\n";
+			++failures;
+			break;
+		}
+	}
+
+	return failures;
+}
+
+int main()
+{
+	std::cout.precision(17);
+
+	const std::vector<real> x(inputs());
+
+	uint failures(0);
+
+	for (const auto& b : bounds)
+	{
+		const Fn fn(b.first);
+
+		/// The scalar kernels must reproduce Functions.hpp exactly
+		std::vector<real> val(x);
+		Kernels::apply_scalar(fn, val.data(), val.size());
+		for (uint i = 0; i < x.size(); ++i)
+		{
+			if (ulp(reference(fn, x[i]), val[i]) > 0.0)
+			{
+				std::cout << "\tscalar " << as_str(fn) << ": x = " << x[i]
+						  << ", reference = " << reference(fn, x[i])
+						  << ", kernel = " << val[i] << "\n";
+				++failures;
+				break;
+			}
+		}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		__builtin_cpu_init();
+
+		if (Kernels::has_avx2() &&
+			__builtin_cpu_supports("avx2") &&
+			__builtin_cpu_supports("fma"))
+		{
+			failures += check("avx2", &Kernels::apply_avx2, fn, x);
+		}
+
+		if (Kernels::has_avx512() &&
+			__builtin_cpu_supports("avx512f"))
+		{
+			failures += check("avx512", &Kernels::apply_avx512, fn, x);
+		}
+#endif
+	}
+
+	/// Leaky integration. The sizes include
+	/// tails shorter than the vector width.
+	std::mt19937_64 rng(42);
+	uint mismatches(0);
+	for (const uint n : {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 1003})
+	{
+		for (uint rep = 0; rep < 20; ++rep)
+		{
+			const State st(state(n, rng));
+
+			/// The scalar version must see the threshold
+			State ref(st);
+			std::vector<uint> spikes(n);
+			const uint count(Kernels::integrate_scalar(ref.al.data(), ref.decay.data(), ref.input.data(), n, spikes.data()));
+			for (uint s = 0; s < count; ++s)
+			{
+				const uint i(spikes[s]);
+				if (st.al[i] * st.decay[i] + st.input[i] < 1.0 ||
+					ordinal(ref.al[i]) != 0)
+				{
+					std::cout << "\tscalar integrate (n = " << n << "): node " << i << " spiked below the threshold\n";
+					++mismatches;
+				}
+			}
+
+			mismatches += check("dispatch", &Kernels::integrate, n, st);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+			if (Kernels::has_avx2() &&
+				__builtin_cpu_supports("avx2") &&
+				__builtin_cpu_supports("fma"))
+			{
+				mismatches += check("avx2", &Kernels::integrate_avx2, n, st);
+			}
+
+			if (Kernels::has_avx512() &&
+				__builtin_cpu_supports("avx512f"))
+			{
+				mismatches += check("avx512", &Kernels::integrate_avx512, n, st);
+			}
+#endif
+		}
+	}
+
+	std::cout << "integrate: " << mismatches << " mismatches" << std::endl;
+	failures += mismatches;
+
+	if (failures > 0)
+	{
+		std::cout << failures << " values exceed the error bounds" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}